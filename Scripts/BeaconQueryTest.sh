@@ -0,0 +1,49 @@
+#!/usr/bin/env bash
+# Beacon query test: several headless dedicated servers on loopback, each with its own game, beacon and metrics port,
+# then a headless client that queries all of them at once with Blackout.Query and exits. The client log has one line
+# per server and "Beacon query: N servers answered in X ms". Exits non-zero if no server answered.
+#
+# Usage: UE4_EDITOR=/path/to/UE4Editor Scripts/BeaconQueryTest.sh [servers=4] [map=Zap]
+set -u
+
+SERVERS=${1:-4}
+MAP=${2:-Zap}
+PROJECT="$(cd "$(dirname "$0")/.." && pwd)/Blackout.uproject"
+EDITOR=${UE4_EDITOR:?Set UE4_EDITOR to the UE4Editor binary}
+# Seconds the servers get to load the map, then how long the query client may take
+READY_TIMEOUT=120
+QUERY_TIMEOUT=120
+TIMEOUT=$((READY_TIMEOUT + QUERY_TIMEOUT + 60))
+
+SERVER_PIDS=()
+ADDRESSES=""
+for i in $(seq 0 $((SERVERS - 1))); do
+	timeout -k 30 $TIMEOUT "$EDITOR" "$PROJECT" "/Game/FirstPersonCPP/Maps/$MAP" -server -nullrhi -nosound -unattended \
+		-log=BeaconServer$i.log -port=$((7777 + i)) -BeaconPort=$((15000 + i)) -MetricsPort=$((9100 + i)) &
+	SERVER_PIDS+=($!)
+	ADDRESSES="$ADDRESSES 127.0.0.1:$((15000 + i))"
+done
+
+# Each server's metrics endpoint answers once its world is up and ticking, which is when its beacon listens too
+for i in $(seq 0 $((SERVERS - 1))); do
+	URL="http://127.0.0.1:$((9100 + i))/metrics"
+	for _ in $(seq 1 $READY_TIMEOUT); do
+		curl -sf -o /dev/null "$URL" && break
+		kill -0 "${SERVER_PIDS[$i]}" 2>/dev/null || break
+		sleep 1
+	done
+	if ! curl -sf -o /dev/null "$URL"; then
+		echo "Server $i did not come up within $READY_TIMEOUT seconds"
+		kill "${SERVER_PIDS[@]}" 2>/dev/null
+		exit 1
+	fi
+done
+
+timeout -k 30 $QUERY_TIMEOUT "$EDITOR" "$PROJECT" -game -nullrhi -nosound -unattended -log=BeaconQueryClient.log \
+	-BeaconQueryExit -ExecCmds="Blackout.Query$ADDRESSES"
+RESULT=$?
+[ $RESULT -eq 124 ] && echo "Query client timed out after $QUERY_TIMEOUT seconds"
+
+kill "${SERVER_PIDS[@]}" 2>/dev/null
+wait "${SERVER_PIDS[@]}" 2>/dev/null
+exit $RESULT
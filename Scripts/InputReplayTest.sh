@@ -0,0 +1,29 @@
+#!/usr/bin/env bash
+# Deterministic replay test: plays an input recording (made with -InputRecord=<name>) in a headless standalone game
+# with the recorded map, seed and frame times. Exits non-zero if the match ends differently from the recording. See
+# FBlackoutInputRecorder.
+#
+# Usage: UE4_EDITOR=/path/to/UE4Editor Scripts/InputReplayTest.sh <recording> [runs=2]
+set -u
+
+RECORDING=${1:?Name of a recording in Saved/InputRecordings}
+RUNS=${2:-2}
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+PROJECT="$ROOT/Blackout.uproject"
+EDITOR=${UE4_EDITOR:?Set UE4_EDITOR to the UE4Editor binary}
+RESULT=0
+
+# Start on the recorded map, the game would open it anyway
+FILE="$RECORDING"
+[[ "$FILE" == *.csv ]] || FILE="$ROOT/Saved/InputRecordings/$RECORDING.csv"
+MAP=$(sed -n 's/^# Map=//p' "$FILE" 2>/dev/null | head -n 1)
+MAP=${MAP:-Zap}
+
+for i in $(seq 1 "$RUNS"); do
+	"$EDITOR" "$PROJECT" "/Game/FirstPersonCPP/Maps/$MAP" -game -nullrhi -nosound -unattended -log=InputReplay$i.log \
+		-InputReplay="$RECORDING" -InputReplayExit
+	STATUS=$?
+	echo "Run $i: exit $STATUS"
+	[ $STATUS -ne 0 ] && RESULT=$STATUS
+done
+exit $RESULT
@@ -0,0 +1,65 @@
+#!/usr/bin/env bash
+# Load test: a headless dedicated server on loopback with a full lobby of headless load clients, all on autopilot.
+# Each client process runs several players over one connection (see FBlackoutLoadGenerator), spread over a few
+# processes. Game load on the server (pawns, movement, projectiles, scoring) covers $PLAYERS players, but replication
+# load only covers $PROCESSES connections, since splitscreen players share their process's connection. Use as many
+# processes as players to load replication per player. Scrapes the server's metrics endpoint at the end, keeps it in
+# LoadTest.metrics (see FBlackoutMetricsServer) and fails unless blackout_players reached $PLAYERS.
+#
+# Usage: UE4_EDITOR=/path/to/UE4Editor Scripts/LoadTest.sh [players=32] [processes=4] [map=Zap] [seconds=120]
+set -u
+
+PLAYERS=${1:-32}
+PROCESSES=${2:-4}
+MAP=${3:-Zap}
+DURATION=${4:-120}
+PROJECT="$(cd "$(dirname "$0")/.." && pwd)/Blackout.uproject"
+EDITOR=${UE4_EDITOR:?Set UE4_EDITOR to the UE4Editor binary}
+METRICS_PORT=9100
+URL="http://127.0.0.1:$METRICS_PORT/metrics"
+# Seconds the server gets to load the map, then how long anything may run before it is killed
+READY_TIMEOUT=120
+TIMEOUT=$((READY_TIMEOUT + DURATION + 120))
+
+timeout -k 30 $TIMEOUT "$EDITOR" "$PROJECT" "/Game/FirstPersonCPP/Maps/$MAP?MaxPlayers=$PLAYERS" -server -nullrhi -nosound \
+	-unattended -log=LoadServer.log -AllowLoadClients -MetricsPort=$METRICS_PORT &
+SERVER_PID=$!
+
+# The metrics endpoint answers once the server's world is up and ticking
+for _ in $(seq 1 $READY_TIMEOUT); do
+	curl -sf -o /dev/null "$URL" && break
+	kill -0 $SERVER_PID 2>/dev/null || break
+	sleep 1
+done
+if ! curl -sf -o /dev/null "$URL"; then
+	echo "Server did not come up within $READY_TIMEOUT seconds"
+	kill $SERVER_PID 2>/dev/null
+	exit 1
+fi
+
+CLIENT_PIDS=()
+for i in $(seq 0 $((PROCESSES - 1))); do
+	# Spread the players evenly, the first processes take the remainder
+	COUNT=$((PLAYERS / PROCESSES + (i < PLAYERS % PROCESSES ? 1 : 0)))
+	[ "$COUNT" -gt 0 ] || continue
+	timeout -k 30 $TIMEOUT "$EDITOR" "$PROJECT" 127.0.0.1 -game -nullrhi -nosound -unattended -log=LoadClient$i.log \
+		-BlackoutLoadClients=$COUNT &
+	CLIENT_PIDS+=($!)
+done
+
+sleep "$DURATION"
+curl -sf "$URL" | tee LoadTest.metrics
+RESULT=${PIPESTATUS[0]}
+
+kill "${CLIENT_PIDS[@]}" "$SERVER_PID" 2>/dev/null
+wait "${CLIENT_PIDS[@]}" "$SERVER_PID" 2>/dev/null
+
+if [ $RESULT -ne 0 ]; then
+	echo "Could not scrape $URL"
+	exit $RESULT
+fi
+JOINED=$(awk '$1 == "blackout_players" { print int($2) }' LoadTest.metrics)
+if [ "${JOINED:-0}" -ne "$PLAYERS" ]; then
+	echo "Only ${JOINED:-0} of $PLAYERS players were in the game"
+	exit 1
+fi
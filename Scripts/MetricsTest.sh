@@ -0,0 +1,39 @@
+#!/usr/bin/env bash
+# Metrics endpoint test: starts a headless dedicated server with -MetricsPort, scrapes it with curl a few times and
+# checks the counters are there. Prints the last scrape. See FBlackoutMetricsServer.
+#
+# Usage: UE4_EDITOR=/path/to/UE4Editor Scripts/MetricsTest.sh [map=Zap] [port=9100]
+set -u
+
+MAP=${1:-Zap}
+PORT=${2:-9100}
+PROJECT="$(cd "$(dirname "$0")/.." && pwd)/Blackout.uproject"
+EDITOR=${UE4_EDITOR:?Set UE4_EDITOR to the UE4Editor binary}
+URL="http://127.0.0.1:$PORT/metrics"
+
+"$EDITOR" "$PROJECT" "/Game/FirstPersonCPP/Maps/$MAP" -server -nullrhi -nosound -unattended -log=MetricsServer.log \
+	-MetricsPort=$PORT &
+SERVER_PID=$!
+
+# Wait for the first snapshot, the server takes a while to load the map
+BODY=""
+for i in $(seq 1 60); do
+	BODY=$(curl -sf "$URL") && break
+	sleep 1
+done
+for i in $(seq 1 5); do
+	BODY=$(curl -sf "$URL") || break
+	sleep 1
+done
+
+kill "$SERVER_PID" 2>/dev/null
+echo "$BODY"
+
+RESULT=0
+for METRIC in players frame_ms game_thread_ms projectiles powerups deaths_per_minute timers_active; do
+	if ! grep -q "^blackout_$METRIC[{ ]" <<< "$BODY"; then
+		echo "Missing blackout_$METRIC"
+		RESULT=1
+	fi
+done
+exit $RESULT
@@ -0,0 +1,86 @@
+#!/usr/bin/env bash
+# Move bandwidth comparison: a headless server on loopback with several headless autopilot clients, run twice. The
+# first run sends moves the engine's way (Blackout.Movement.Compact 0, at the engine's default 60 Hz send rate), the
+# second with quantized acceleration and the capped send rate. Samples the server's metrics endpoint every second and
+# reports upstream bytes per second per connection, moves per second and bytes per move for each, appended to
+# Saved/Profiling/MoveBandwidth.csv. Upstream bytes also include fire RPCs and acks, which both runs share.
+#
+# Usage: UE4_EDITOR=/path/to/UE4Editor Scripts/MoveBandwidthTest.sh [clients=4] [seconds=60] [map=Zap]
+set -u
+
+CLIENTS=${1:-4}
+SECONDS_TO_RUN=${2:-60}
+MAP=${3:-Zap}
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+PROJECT="$ROOT/Blackout.uproject"
+EDITOR=${UE4_EDITOR:?Set UE4_EDITOR to the UE4Editor binary}
+PORT=7777
+METRICS_PORT=9100
+URL="http://127.0.0.1:$METRICS_PORT/metrics"
+CSV="$ROOT/Saved/Profiling/MoveBandwidth.csv"
+# Seconds the server gets to load the map, and the clients to join and start moving
+READY_TIMEOUT=120
+WARMUP=15
+TIMEOUT=$((READY_TIMEOUT + WARMUP + SECONDS_TO_RUN + 120))
+RESULT=0
+
+mkdir -p "$(dirname "$CSV")"
+[ -f "$CSV" ] || echo "Map,Clients,Compact,UpstreamBytesPerSecondPerConnection,MovesPerSecond,BytesPerMove" > "$CSV"
+
+for COMPACT in 0 1; do
+	timeout -k 30 $TIMEOUT "$EDITOR" "$PROJECT" "/Game/FirstPersonCPP/Maps/$MAP" -server -nullrhi -nosound -unattended \
+		-log=MoveBandwidthServer$COMPACT.log -port=$PORT -MetricsPort=$METRICS_PORT &
+	SERVER=$!
+
+	# The metrics endpoint answers once the server's world is up and ticking
+	for _ in $(seq 1 $READY_TIMEOUT); do
+		curl -sf -o /dev/null "$URL" && break
+		kill -0 $SERVER 2>/dev/null || break
+		sleep 1
+	done
+	if ! curl -sf -o /dev/null "$URL"; then
+		echo "Compact $COMPACT: server did not come up within $READY_TIMEOUT seconds"
+		kill $SERVER 2>/dev/null
+		RESULT=1
+		continue
+	fi
+
+	# The engine's own send interval for the old path, DefaultGame.ini lowers it to match MaxMoveSendRate
+	SEND_RATE=""
+	[ $COMPACT -eq 0 ] && SEND_RATE="-ini:Game:[/Script/Engine.GameNetworkManager]:ClientNetSendMoveDeltaTime=0.0166"
+	CLIENT_PIDS=()
+	for i in $(seq 1 "$CLIENTS"); do
+		timeout -k 30 $TIMEOUT "$EDITOR" "$PROJECT" 127.0.0.1:$PORT -game -nullrhi -nosound -unattended \
+			-log=MoveBandwidthClient$COMPACT-$i.log $SEND_RATE \
+			-ExecCmds="Blackout.Autopilot 1, Blackout.Movement.Compact $COMPACT" &
+		CLIENT_PIDS+=($!)
+	done
+	sleep $WARMUP
+
+	START_MOVES=$(curl -sf "$URL" | awk '$1 == "blackout_client_moves_total" { print $2 }')
+	BYTES_SUM=0
+	for _ in $(seq 1 "$SECONDS_TO_RUN"); do
+		sleep 1
+		BYTES=$(curl -sf "$URL" | awk '$1 ~ /^blackout_connection_in_bytes_per_second/ { sum += $2; n++ } END { print n ? sum / n : 0 }')
+		BYTES_SUM=$(awk -v a="$BYTES_SUM" -v b="${BYTES:-0}" 'BEGIN { print a + b }')
+	done
+	BODY=$(curl -sf "$URL")
+	END_MOVES=$(awk '$1 == "blackout_client_moves_total" { print $2 }' <<< "$BODY")
+	JOINED=$(awk '$1 == "blackout_connections" { print int($2) }' <<< "$BODY")
+
+	kill "${CLIENT_PIDS[@]}" $SERVER 2>/dev/null
+	wait "${CLIENT_PIDS[@]}" $SERVER 2>/dev/null
+
+	if [ "${JOINED:-0}" -ne "$CLIENTS" ]; then
+		echo "Compact $COMPACT: only ${JOINED:-0} of $CLIENTS clients connected"
+		RESULT=1
+		continue
+	fi
+	awk -v map="$MAP" -v clients="$CLIENTS" -v compact="$COMPACT" -v seconds="$SECONDS_TO_RUN" \
+		-v bytes="$BYTES_SUM" -v start="${START_MOVES:-0}" -v end="${END_MOVES:-0}" 'BEGIN {
+		upstream = bytes / seconds
+		moves = (end - start) / seconds / clients
+		printf "%s,%d,%d,%.1f,%.1f,%.1f\n", map, clients, compact, upstream, moves, (moves > 0 ? upstream / moves : 0)
+	}' | tee -a "$CSV"
+done
+exit $RESULT
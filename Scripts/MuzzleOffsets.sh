@@ -0,0 +1,44 @@
+#!/usr/bin/env bash
+# Muzzle offset measurement: replays an input recording (made with -InputRecord=<name>, ideally running, jumping and
+# firing) in a windowed standalone game with Blackout.Muzzle.Validate on, so the first person arms really animate.
+# On exit the game logs one +MuzzleOffsets line per gun with its averaged offset and worst error, see
+# ABlackoutCharacter::GetMuzzleLocation. With write=1 the lines replace that gun's entry in Config/DefaultGame.ini,
+# keeping its MaxError (5 by default), which is a tolerance chosen by hand. Exits non-zero if nothing was measured or
+# a gun strayed further than its MaxError from the offset in use, so run it again after writing to validate the entry.
+#
+# Usage: UE4_EDITOR=/path/to/UE4Editor Scripts/MuzzleOffsets.sh <recording> [map=Zap] [write=0]
+set -u
+
+RECORDING=${1:?Name of a recording in Saved/InputRecordings}
+MAP=${2:-Zap}
+WRITE=${3:-0}
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+PROJECT="$ROOT/Blackout.uproject"
+EDITOR=${UE4_EDITOR:?Set UE4_EDITOR to the UE4Editor binary}
+LOG="$ROOT/Saved/Logs/MuzzleOffsets.log"
+INI="$ROOT/Config/DefaultGame.ini"
+
+rm -f "$LOG"
+# Not -nullrhi: the arms are only posed while they are rendered. The replay's own result doesn't matter here.
+"$EDITOR" "$PROJECT" "/Game/FirstPersonCPP/Maps/$MAP" -game -windowed -ResX=640 -ResY=360 -nosound -unattended \
+	-log=MuzzleOffsets.log -InputReplay="$RECORDING" -InputReplayExit -ExecCmds="Blackout.Muzzle.Validate 1"
+
+grep -E "frames, max error" "$LOG" | sed 's/.*LogBlackout: Display: //'
+LINES=$(grep -oE '\+MuzzleOffsets=.*' "$LOG")
+[ -n "$LINES" ] || { echo "Nothing was measured, see $LOG"; exit 1; }
+echo "$LINES"
+
+if [ "$WRITE" = 1 ]; then
+	grep -q '^\[/Script/Blackout.BlackoutCharacter\]' "$INI" || printf '\n[/Script/Blackout.BlackoutCharacter]\n' >> "$INI"
+	while IFS= read -r LINE; do
+		WEAPON=$(echo "$LINE" | grep -oE 'Weapon="[^"]*"')
+		grep -vF "+MuzzleOffsets=($WEAPON," "$INI" > "$INI.tmp" && mv "$INI.tmp" "$INI"
+		awk -v line="$LINE" '/^\[\/Script\/Blackout.BlackoutCharacter\]/ { section = 1; print; next }
+			section && !/^;/ { print line; section = 0 }
+			{ print }
+			END { if (section) print line }' "$INI" > "$INI.tmp" && mv "$INI.tmp" "$INI"
+	done <<< "$LINES"
+	echo "Updated $INI"
+fi
+
+! grep -q "FAILED" "$LOG"
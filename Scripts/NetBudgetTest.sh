@@ -0,0 +1,46 @@
+#!/usr/bin/env bash
+# Bandwidth regression test: a headless server on Zap plus several headless autopilot clients on loopback.
+# The server writes Saved/Profiling/NetBudget.csv and exits non-zero if a budget in DefaultEngine.ini is exceeded.
+#
+# Usage: UE4_EDITOR=/path/to/UE4Editor Scripts/NetBudgetTest.sh [clients=4] [seconds=60] [map=Zap]
+set -u
+
+CLIENTS=${1:-4}
+SECONDS_TO_RUN=${2:-60}
+MAP=${3:-Zap}
+PROJECT="$(cd "$(dirname "$0")/.." && pwd)/Blackout.uproject"
+EDITOR=${UE4_EDITOR:?Set UE4_EDITOR to the UE4Editor binary}
+PORT=7777
+METRICS_PORT=9100
+# Seconds the server gets to load the map, and every process gets on top of the test before it is killed
+READY_TIMEOUT=120
+TIMEOUT=$((READY_TIMEOUT + SECONDS_TO_RUN + 120))
+
+timeout -k 30 $TIMEOUT "$EDITOR" "$PROJECT" "/Game/FirstPersonCPP/Maps/$MAP" -server -nullrhi -nosound -unattended -log \
+	-port=$PORT -NetBudgetTest=$SECONDS_TO_RUN -MetricsPort=$METRICS_PORT &
+SERVER=$!
+
+# The metrics endpoint answers once the server's world is up and ticking
+for _ in $(seq 1 $READY_TIMEOUT); do
+	curl -sf -o /dev/null "http://127.0.0.1:$METRICS_PORT/metrics" && break
+	kill -0 $SERVER 2>/dev/null || break
+	sleep 1
+done
+if ! curl -sf -o /dev/null "http://127.0.0.1:$METRICS_PORT/metrics"; then
+	echo "Server did not come up within $READY_TIMEOUT seconds"
+	kill $SERVER 2>/dev/null
+	exit 1
+fi
+
+CLIENT_PIDS=()
+for i in $(seq 1 "$CLIENTS"); do
+	timeout -k 30 $TIMEOUT "$EDITOR" "$PROJECT" 127.0.0.1:$PORT -game -nullrhi -nosound -unattended -log=NetBudgetClient$i.log \
+		-ExecCmds="Blackout.Autopilot 1" &
+	CLIENT_PIDS+=($!)
+done
+
+wait $SERVER
+RESULT=$?
+[ $RESULT -eq 124 ] && echo "Server timed out after $TIMEOUT seconds"
+kill "${CLIENT_PIDS[@]}" 2>/dev/null
+exit $RESULT
@@ -0,0 +1,62 @@
+#!/usr/bin/env bash
+# Full match performance test: for each map, a headless dedicated server plus several headless autopilot clients
+# on loopback. Each server writes Saved/Profiling/PerfTest_<Map>.json and exits non-zero if a gate in
+# DefaultGame.ini regressed against Perf/Baseline_<Map>.json. A baseline still marked "Pending" is filled in by the
+# run instead. See ABlackoutPerfTestController.
+#
+# Usage: UE4_EDITOR=/path/to/UE4Editor Scripts/PerfTest.sh [clients=8] [seconds=120] [maps="Zap Maze"] [-PerfTestUpdateBaseline]
+set -u
+
+CLIENTS=${1:-8}
+SECONDS_TO_RUN=${2:-120}
+MAPS=${3:-Zap Maze}
+EXTRA=${4:-}
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+PROJECT="$ROOT/Blackout.uproject"
+EDITOR=${UE4_EDITOR:?Set UE4_EDITOR to the UE4Editor binary}
+PORT=7777
+METRICS_PORT=9100
+# Seconds the server gets to load the map, and every process gets on top of warmup and measurement before it is killed
+READY_TIMEOUT=120
+TIMEOUT=$((READY_TIMEOUT + SECONDS_TO_RUN + 180))
+RESULT=0
+
+for MAP in $MAPS; do
+	timeout -k 30 $TIMEOUT "$EDITOR" "$PROJECT" "/Game/FirstPersonCPP/Maps/$MAP" -server -nullrhi -nosound -unattended -log=PerfTest$MAP.log \
+		-port=$PORT -BlackoutPerfTest=$SECONDS_TO_RUN -MetricsPort=$METRICS_PORT $EXTRA &
+	SERVER=$!
+
+	# The metrics endpoint answers once the server's world is up and ticking
+	for _ in $(seq 1 $READY_TIMEOUT); do
+		curl -sf -o /dev/null "http://127.0.0.1:$METRICS_PORT/metrics" && break
+		kill -0 $SERVER 2>/dev/null || break
+		sleep 1
+	done
+	if ! curl -sf -o /dev/null "http://127.0.0.1:$METRICS_PORT/metrics"; then
+		echo "$MAP: server did not come up within $READY_TIMEOUT seconds"
+		kill $SERVER 2>/dev/null
+		wait $SERVER
+		RESULT=1
+		continue
+	fi
+
+	CLIENT_PIDS=()
+	for i in $(seq 1 "$CLIENTS"); do
+		timeout -k 30 $TIMEOUT "$EDITOR" "$PROJECT" 127.0.0.1:$PORT -game -nullrhi -nosound -unattended -log=PerfTestClient$MAP$i.log \
+			-ExecCmds="Blackout.Autopilot 1" &
+		CLIENT_PIDS+=($!)
+	done
+
+	wait $SERVER
+	STATUS=$?
+	kill "${CLIENT_PIDS[@]}" 2>/dev/null
+	wait "${CLIENT_PIDS[@]}" 2>/dev/null
+	[ $STATUS -eq 124 ] && echo "$MAP: server timed out after $TIMEOUT seconds"
+	echo "$MAP: exit $STATUS"
+	[ $STATUS -ne 0 ] && RESULT=$STATUS
+done
+
+# Pending baselines are filled in by their first run, and -PerfTestUpdateBaseline rewrites them, both to be committed
+CHANGED=$(git -C "$ROOT" status --porcelain -- Perf 2>/dev/null)
+[ -n "$CHANGED" ] && printf 'Baselines changed, review and commit them:\n%s\n' "$CHANGED"
+exit $RESULT
@@ -0,0 +1,63 @@
+#!/usr/bin/env bash
+# Round turnaround comparison: a headless dedicated server on loopback with a few headless autopilot clients, run
+# twice. The first run starts each new round by reloading the map (Blackout.ReloadMatch), the second by resetting it
+# in place (Blackout.ResetMatch). The server times every turnaround, from the end of a round to the first frame of the
+# next, appends p50 / p95 / max to Saved/Profiling/RoundTurnaround.csv and exits, see UBlackoutGameInstance.
+#
+# Usage: UE4_EDITOR=/path/to/UE4Editor Scripts/RoundResetTest.sh [clients=4] [rounds=10] [map=Zap]
+set -u
+
+CLIENTS=${1:-4}
+ROUNDS=${2:-10}
+MAP=${3:-Zap}
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+PROJECT="$ROOT/Blackout.uproject"
+EDITOR=${UE4_EDITOR:?Set UE4_EDITOR to the UE4Editor binary}
+PORT=7777
+METRICS_PORT=9100
+URL="http://127.0.0.1:$METRICS_PORT/metrics"
+CSV="$ROOT/Saved/Profiling/RoundTurnaround.csv"
+# Seconds the server gets to load the map. A run then takes the 30 second warmup and well under a minute per round.
+READY_TIMEOUT=120
+TIMEOUT=$((READY_TIMEOUT + 30 + ROUNDS * 60 + 120))
+RESULT=0
+
+for KIND in reload reset; do
+	timeout -k 30 $TIMEOUT "$EDITOR" "$PROJECT" "/Game/FirstPersonCPP/Maps/$MAP" -server -nullrhi -nosound -unattended \
+		-log=RoundTest-$KIND.log -port=$PORT -MetricsPort=$METRICS_PORT -RoundTest=$KIND -RoundTestRounds=$ROUNDS &
+	SERVER=$!
+
+	# The metrics endpoint answers once the server's world is up and ticking
+	for _ in $(seq 1 $READY_TIMEOUT); do
+		curl -sf -o /dev/null "$URL" && break
+		kill -0 $SERVER 2>/dev/null || break
+		sleep 1
+	done
+	if ! curl -sf -o /dev/null "$URL"; then
+		echo "$KIND: server did not come up within $READY_TIMEOUT seconds"
+		kill $SERVER 2>/dev/null
+		RESULT=1
+		continue
+	fi
+
+	CLIENT_PIDS=()
+	for i in $(seq 1 "$CLIENTS"); do
+		timeout -k 30 $TIMEOUT "$EDITOR" "$PROJECT" 127.0.0.1:$PORT -game -nullrhi -nosound -unattended \
+			-log=RoundTestClient-$KIND-$i.log -ExecCmds="Blackout.Autopilot 1" &
+		CLIENT_PIDS+=($!)
+	done
+
+	# The server exits by itself once every round is timed
+	wait $SERVER
+	STATUS=$?
+	kill "${CLIENT_PIDS[@]}" 2>/dev/null
+	wait "${CLIENT_PIDS[@]}" 2>/dev/null
+	if [ $STATUS -ne 0 ]; then
+		[ $STATUS -eq 124 ] && echo "$KIND: server timed out after $TIMEOUT seconds"
+		echo "$KIND: server exited with $STATUS"
+		RESULT=1
+	fi
+done
+
+[ -f "$CSV" ] && cat "$CSV"
+exit $RESULT
@@ -0,0 +1,98 @@
+#!/usr/bin/env bash
+# Proxy smoothness comparison: a headless server on loopback with several headless autopilot clients, watched by one
+# more client that measures how smoothly their characters and projectiles move (Blackout.Smoothness). Runs four
+# times: packet lag emulation off and on (Net PktLag/PktLagVariance on the watching client), each with
+# Blackout.ProxySmoothing off and on. The watching client logs Blackout.Smoothness.Report when it shuts down, the
+# lines are appended to Saved/Profiling/Smoothness.csv.
+#
+# Usage: UE4_EDITOR=/path/to/UE4Editor Scripts/SmoothnessTest.sh [clients=4] [seconds=60] [map=Zap] [lag=100] [variance=50]
+set -u
+
+CLIENTS=${1:-4}
+SECONDS_TO_RUN=${2:-60}
+MAP=${3:-Zap}
+LAG=${4:-100}
+VARIANCE=${5:-50}
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+PROJECT="$ROOT/Blackout.uproject"
+EDITOR=${UE4_EDITOR:?Set UE4_EDITOR to the UE4Editor binary}
+PORT=7777
+METRICS_PORT=9100
+URL="http://127.0.0.1:$METRICS_PORT/metrics"
+CSV="$ROOT/Saved/Profiling/Smoothness.csv"
+# Seconds the server gets to load the map, and the clients to join and start moving
+READY_TIMEOUT=120
+WARMUP=15
+TIMEOUT=$((READY_TIMEOUT + WARMUP + SECONDS_TO_RUN + 120))
+RESULT=0
+
+mkdir -p "$(dirname "$CSV")"
+[ -f "$CSV" ] || echo "Map,Clients,PktLag,PktLagVariance,ProxySmoothing,Category,Frames,P50,P90,P99,Max" > "$CSV"
+
+for EMULATION in 0 1; do
+	for SMOOTHING in 0 1; do
+		RUN="Lag$EMULATION-Smoothing$SMOOTHING"
+		RUN_LAG=$((EMULATION * LAG))
+		RUN_VARIANCE=$((EMULATION * VARIANCE))
+		LOG="$ROOT/Saved/Logs/SmoothnessWatcher$RUN.log"
+
+		timeout -k 30 $TIMEOUT "$EDITOR" "$PROJECT" "/Game/FirstPersonCPP/Maps/$MAP" -server -nullrhi -nosound -unattended \
+			-log=SmoothnessServer$RUN.log -port=$PORT -MetricsPort=$METRICS_PORT &
+		SERVER=$!
+
+		# The metrics endpoint answers once the server's world is up and ticking
+		for _ in $(seq 1 $READY_TIMEOUT); do
+			curl -sf -o /dev/null "$URL" && break
+			kill -0 $SERVER 2>/dev/null || break
+			sleep 1
+		done
+		if ! curl -sf -o /dev/null "$URL"; then
+			echo "$RUN: server did not come up within $READY_TIMEOUT seconds"
+			kill $SERVER 2>/dev/null
+			RESULT=1
+			continue
+		fi
+
+		CLIENT_PIDS=()
+		for i in $(seq 1 "$CLIENTS"); do
+			timeout -k 30 $TIMEOUT "$EDITOR" "$PROJECT" 127.0.0.1:$PORT -game -nullrhi -nosound -unattended \
+				-log=SmoothnessClient$RUN-$i.log -ExecCmds="Blackout.Autopilot 1" &
+			CLIENT_PIDS+=($!)
+		done
+		sleep $WARMUP
+		JOINED=$(curl -sf "$URL" | awk '$1 == "blackout_connections" { print int($2) }')
+		if [ "${JOINED:-0}" -ne "$CLIENTS" ]; then
+			echo "$RUN: only ${JOINED:-0} of $CLIENTS clients connected"
+			kill "${CLIENT_PIDS[@]}" $SERVER 2>/dev/null
+			wait "${CLIENT_PIDS[@]}" $SERVER 2>/dev/null
+			RESULT=1
+			continue
+		fi
+
+		# The watcher joins once everyone else is in and moving, so it measures from then on
+		timeout -k 30 $TIMEOUT "$EDITOR" "$PROJECT" 127.0.0.1:$PORT -game -nullrhi -nosound -unattended \
+			-log=SmoothnessWatcher$RUN.log \
+			-ExecCmds="Blackout.Smoothness 1, Blackout.ProxySmoothing $SMOOTHING, Net PktLag=$RUN_LAG, Net PktLagVariance=$RUN_VARIANCE" &
+		WATCHER=$!
+		sleep "$SECONDS_TO_RUN"
+
+		# SIGTERM shuts the watcher down cleanly, which logs the report
+		kill $WATCHER 2>/dev/null
+		wait $WATCHER 2>/dev/null
+		kill "${CLIENT_PIDS[@]}" $SERVER 2>/dev/null
+		wait "${CLIENT_PIDS[@]}" $SERVER 2>/dev/null
+
+		# "  Character       1234 frames  p50 1.00 / p90 2.00 / p99 3.00 / max 4.00"
+		LINES=$(grep -E 'LogBlackout: Display: +[A-Za-z]+ +[0-9]+ frames +p50' "$LOG" 2>/dev/null)
+		if [ -z "$LINES" ]; then
+			echo "$RUN: no smoothness report in $LOG"
+			RESULT=1
+			continue
+		fi
+		sed 's/.*LogBlackout: Display: *//' <<< "$LINES" | awk -v map="$MAP" -v clients="$CLIENTS" \
+			-v lag="$RUN_LAG" -v variance="$RUN_VARIANCE" -v smoothing="$SMOOTHING" '{
+			printf "%s,%d,%d,%d,%d,%s,%d,%s,%s,%s,%s\n", map, clients, lag, variance, smoothing, $1, $2, $5, $8, $11, $14
+		}' | tee -a "$CSV"
+	done
+done
+exit $RESULT
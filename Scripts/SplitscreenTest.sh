@@ -0,0 +1,33 @@
+#!/usr/bin/env bash
+# Split-screen scaling test: runs a headless standalone game with 1 to 4 local players on autopilot and records game
+# thread time for each into Saved/Profiling/Splitscreen.csv. Passes only if the cost grows sub-linearly: the 3rd and
+# 4th players must cost less on average than the 2nd did, and the 2nd less than the 1st. See ABlackoutSplitscreen.
+#
+# Usage: UE4_EDITOR=/path/to/UE4Editor Scripts/SplitscreenTest.sh [map=Zap] [seconds=60]
+set -u
+
+MAP=${1:-Zap}
+SECONDS_PER_RUN=${2:-60}
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+PROJECT="$ROOT/Blackout.uproject"
+EDITOR=${UE4_EDITOR:?Set UE4_EDITOR to the UE4Editor binary}
+CSV="$ROOT/Saved/Profiling/Splitscreen.csv"
+
+rm -f "$CSV"
+for PLAYERS in 1 2 3 4; do
+	"$EDITOR" "$PROJECT" "/Game/FirstPersonCPP/Maps/$MAP" -game -nullrhi -nosound -unattended -log=Splitscreen$PLAYERS.log \
+		-BlackoutLocalPlayers=$PLAYERS -SplitscreenTest=$SECONDS_PER_RUN -ExecCmds="Blackout.Autopilot 1" || exit $?
+done
+
+[ -f "$CSV" ] || { echo "No results in $CSV"; exit 1; }
+cat "$CSV"
+
+# Column 3 is the median game thread time, one row per player count in order
+awk -F, 'NR > 1 { ms[$2] = $3 }
+	END {
+		second = ms[2] - ms[1]
+		rest = ms[4] - ms[2]
+		printf "Cost of the 1st player %.2f ms, of the 2nd %.2f ms, of the 3rd and 4th %.2f ms\n", ms[1], second, rest
+		if (!(second < ms[1] && rest < 2 * second)) { print "Split-screen cost does not grow sub-linearly"; exit 1 }
+		print "Split-screen cost grows sub-linearly"
+	}' "$CSV"
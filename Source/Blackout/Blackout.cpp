@@ -1,7 +1,18 @@
 // Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
 
 #include "Blackout.h"
+#include "BlackoutMemory.h"
 #include "Modules/ModuleManager.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Blackout, "Blackout" );
- 
\ No newline at end of file
+DEFINE_LOG_CATEGORY(LogBlackout);
+
+class FBlackoutModule : public FDefaultGameModuleImpl
+{
+public:
+	void StartupModule() override
+	{
+		BlackoutMemory::RegisterTags();
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FBlackoutModule, Blackout, "Blackout" );
@@ -3,3 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogBlackout, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("Blackout"), STATGROUP_Blackout, STATCAT_Advanced);
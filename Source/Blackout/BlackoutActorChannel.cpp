@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutActorChannel.h"
+#include "BlackoutNetDriver.h"
+#include "Engine/NetConnection.h"
+#include "Net/DataBunch.h"
+
+UBlackoutActorChannel::UBlackoutActorChannel(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+}
+
+FPacketIdRange UBlackoutActorChannel::SendBunch(FOutBunch* Bunch, bool Merge)
+{
+	if (UBlackoutNetDriver* driver = Connection ? Cast<UBlackoutNetDriver>(Connection->Driver) : nullptr) {
+		driver->TrackBunch(Connection, Actor, Bunch->GetNumBits());
+	}
+	return Super::SendBunch(Bunch, Merge);
+}
@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/ActorChannel.h"
+#include "BlackoutActorChannel.generated.h"
+
+/**
+ * Actor channel that reports the size of every bunch it sends to UBlackoutNetDriver.
+ * Registered through the driver's ChannelDefinitions in DefaultEngine.ini.
+ */
+UCLASS(transient, customConstructor)
+class BLACKOUT_API UBlackoutActorChannel : public UActorChannel
+{
+	GENERATED_BODY()
+
+public:
+	UBlackoutActorChannel(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+	FPacketIdRange SendBunch(FOutBunch* Bunch, bool Merge) override;
+};
@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutAnimationBudget.h"
+#include "Blackout.h"
+#include "BlackoutCharacter.h"
+#include "BlackoutProjectile.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_CYCLE_STAT(TEXT("Animation budget"), STAT_AnimationBudget, STATGROUP_Blackout);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Remote characters animated every frame"), STAT_AnimationBudgetFullRate, STATGROUP_Blackout);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Remote characters animated at reduced rate"), STAT_AnimationBudgetReduced, STATGROUP_Blackout);
+
+ABlackoutAnimationBudget::ABlackoutAnimationBudget()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	// Rank before the meshes tick, so this frame's intervals already apply
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+	bReplicates = false;
+
+	BudgetMs = 1.5f;
+	EstimatedCostMs = 0.1f;
+	MaxTickInterval = 0.25f;
+	MaxSignificanceDistance = 8000.f;
+}
+
+ABlackoutAnimationBudget* ABlackoutAnimationBudget::Get(UWorld* world)
+{
+	if (!world || world->GetNetMode() == NM_DedicatedServer) {
+		return nullptr;
+	}
+	for (TActorIterator<ABlackoutAnimationBudget> it(world); it; ++it) {
+		return *it;
+	}
+	return world->SpawnActor<ABlackoutAnimationBudget>();
+}
+
+void ABlackoutAnimationBudget::Register(ABlackoutCharacter* character)
+{
+	Characters.AddUnique(character);
+}
+
+void ABlackoutAnimationBudget::Unregister(ABlackoutCharacter* character)
+{
+	Characters.RemoveSingleSwap(character);
+}
+
+void ABlackoutAnimationBudget::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AnimationBudget);
+	Super::Tick(DeltaSeconds);
+
+	// Every local player's view in split-screen, ranked in one pass so extra players don't each pay for it
+	TArray<TPair<FVector, float>, TInlineAllocator<4>> views;
+	for (FConstPlayerControllerIterator it = GetWorld()->GetPlayerControllerIterator(); it; ++it) {
+		APlayerController* viewer = it->Get();
+		if (viewer && viewer->IsLocalController() && viewer->PlayerCameraManager) {
+			FVector viewLocation;
+			FRotator viewRotation;
+			viewer->GetPlayerViewPoint(viewLocation, viewRotation);
+			views.Emplace(viewLocation, viewer->PlayerCameraManager->GetFOVAngle());
+		}
+	}
+	if (views.Num() == 0) {
+		return;
+	}
+
+	// Projectile lights are the only thing that makes a character properly visible
+	TArray<FSphere> lights;
+	for (TActorIterator<ABlackoutProjectile> it(GetWorld()); it; ++it) {
+		lights.Emplace(it->GetActorLocation(), it->DefaultLightAttenuationRadius);
+	}
+
+	TArray<TPair<float, ABlackoutCharacter*>> ranked;
+	for (ABlackoutCharacter* character : Characters) {
+		if (!character || character->IsPendingKill()) {
+			continue;
+		}
+		if (character->IsLocallyControlled()) {
+			// Registered before its controller arrived, our own pawn always animates fully
+			SetAnimationTickInterval(character, 0.f);
+			continue;
+		}
+		float significance = 0.f;
+		for (const TPair<FVector, float>& view : views) {
+			significance = FMath::Max(significance, CalculateSignificance(character, view.Key, view.Value, lights));
+		}
+		ranked.Emplace(significance, character);
+	}
+	ranked.Sort([](const TPair<float, ABlackoutCharacter*>& a, const TPair<float, ABlackoutCharacter*>& b) { return a.Key > b.Key; });
+
+	// The most significant characters get every frame, the rest are spread out by rank
+	const int32 fullRate = FMath::Max(1, FMath::FloorToInt(BudgetMs / FMath::Max(EstimatedCostMs, KINDA_SMALL_NUMBER)));
+	for (int32 i = 0; i < ranked.Num(); i++) {
+		float interval = 0.f;
+		if (i >= fullRate && ranked.Num() > fullRate) {
+			const float overBudget = float(i - fullRate + 1) / float(ranked.Num() - fullRate);
+			interval = MaxTickInterval * overBudget * (1.f - FMath::Min(ranked[i].Key, 1.f) * 0.5f);
+		}
+		SetAnimationTickInterval(ranked[i].Value, interval);
+	}
+
+	INC_DWORD_STAT_BY(STAT_AnimationBudgetFullRate, FMath::Min(fullRate, ranked.Num()));
+	INC_DWORD_STAT_BY(STAT_AnimationBudgetReduced, FMath::Max(0, ranked.Num() - fullRate));
+}
+
+float ABlackoutAnimationBudget::CalculateSignificance(const ABlackoutCharacter* character, const FVector& viewLocation, float viewFOV, const TArray<FSphere>& lights) const
+{
+	const FVector location = character->GetActorLocation();
+	const float distance = FVector::Dist(viewLocation, location);
+	if (distance > MaxSignificanceDistance) {
+		return 0.f;
+	}
+
+	// Fraction of the screen height the character's bounds cover
+	const float radius = character->GetSimpleCollisionRadius() * 2.f;
+	const float screenSize = FMath::Clamp(radius / FMath::Max(1.f, distance * FMath::Tan(FMath::DegreesToRadians(viewFOV * 0.5f))), 0.f, 1.f);
+
+	const USkeletalMeshComponent* mesh = character->GetMesh();
+	const bool onScreen = mesh && mesh->WasRecentlyRendered(0.2f);
+
+	// In the dark a character is barely visible however close it is
+	const bool lit = lights.ContainsByPredicate([&location](const FSphere& light) { return light.IsInside(location); });
+
+	return screenSize * (onScreen ? 1.f : 0.1f) * (lit ? 1.f : 0.4f) * (1.f - distance / MaxSignificanceDistance);
+}
+
+void ABlackoutAnimationBudget::SetAnimationTickInterval(ABlackoutCharacter* character, float interval)
+{
+	if (USkeletalMeshComponent* mesh = character->GetMesh()) {
+		if (mesh->PrimaryComponentTick.TickInterval != interval) {
+			mesh->SetComponentTickInterval(interval);
+		}
+	}
+}
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "BlackoutAnimationBudget.generated.h"
+
+class ABlackoutCharacter;
+
+/**
+ * Client side budget for animating remote characters. Every frame, remote characters are ranked by how much
+ * they matter to the local players (on screen, screen size, distance, lit by a projectile) and only as many as fit
+ * in BudgetMs animate every frame. The rest have their skeletal mesh ticks spread out further the less they matter.
+ *
+ * One is spawned per world the first time a remote character registers, see Get.
+ */
+UCLASS(config=Game)
+class BLACKOUT_API ABlackoutAnimationBudget : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	ABlackoutAnimationBudget();
+
+	/** Returns the world's budget, spawning it if needed. Null on dedicated servers, which never animate remotes. */
+	static ABlackoutAnimationBudget* Get(UWorld* world);
+
+	void Register(ABlackoutCharacter* character);
+	void Unregister(ABlackoutCharacter* character);
+
+	void Tick(float DeltaSeconds) override;
+
+	/** Game thread time remote character animation may take each frame */
+	UPROPERTY(Config, EditAnywhere, Category = "Animation")
+	float BudgetMs;
+
+	/** Estimated cost of animating one character for a frame. Measure with `stat anim` and tune per platform. */
+	UPROPERTY(Config, EditAnywhere, Category = "Animation")
+	float EstimatedCostMs;
+
+	/** Longest a character may go between animation updates, for the least significant ones */
+	UPROPERTY(Config, EditAnywhere, Category = "Animation")
+	float MaxTickInterval;
+
+	/** Characters further than this count as not significant at all */
+	UPROPERTY(Config, EditAnywhere, Category = "Animation")
+	float MaxSignificanceDistance;
+
+private:
+	/** How much a character matters to one local view, higher is more. In split-screen the best view counts. */
+	float CalculateSignificance(const ABlackoutCharacter* character, const FVector& viewLocation, float viewFOV, const TArray<FSphere>& lights) const;
+
+	/** Applies a tick interval to every animated mesh of a character */
+	static void SetAnimationTickInterval(ABlackoutCharacter* character, float interval);
+
+	UPROPERTY()
+	TArray<ABlackoutCharacter*> Characters;
+};
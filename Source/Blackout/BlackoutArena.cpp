@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutArena.h"
+#include "Blackout.h"
+#include "BlackoutPlayerState.h"
+#include "Powerup.h"
+#include "Engine/Level.h"
+#include "Engine/LevelStreamingDynamic.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerStart.h"
+#include "Misc/PackageName.h"
+#include "Net/UnrealNetwork.h"
+
+ABlackoutArena::ABlackoutArena()
+{
+	bReplicates = true;
+	bAlwaysRelevant = false;
+	bOnlyRelevantToOwner = false;
+	NetUpdateFrequency = 1.f;
+}
+
+void ABlackoutArena::Init(int32 index, const FString& levelName, const FVector& origin)
+{
+	ArenaIndex = index;
+	LevelName = levelName;
+	Origin = origin;
+	SetActorLocation(origin);
+}
+
+void ABlackoutArena::BeginPlay()
+{
+	Super::BeginPlay();
+	LoadLevelInstance();
+}
+
+void ABlackoutArena::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (LevelInstance) {
+		LevelInstance->OnLevelShown.RemoveDynamic(this, &ABlackoutArena::OnLevelShown);
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+void ABlackoutArena::LoadLevelInstance()
+{
+	if (LevelInstance || LevelName.IsEmpty()) {
+		return;
+	}
+
+	// The server and its clients must agree on the instance's package name, or the client will never report the
+	// level as visible and nothing inside it will replicate.
+	const FString instanceName = FString::Printf(TEXT("%s_Arena%d"), *FPackageName::GetShortName(LevelName), ArenaIndex);
+
+	bool success = false;
+	LevelInstance = ULevelStreamingDynamic::LoadLevelInstance(this, LevelName, Origin, FRotator::ZeroRotator, success, instanceName);
+	if (!success || !LevelInstance) {
+		UE_LOG(LogBlackout, Error, TEXT("Arena %d could not load %s"), ArenaIndex, *LevelName);
+		return;
+	}
+
+	LevelInstance->OnLevelShown.AddDynamic(this, &ABlackoutArena::OnLevelShown);
+}
+
+void ABlackoutArena::OnLevelShown()
+{
+	ULevel* level = LevelInstance ? LevelInstance->GetLoadedLevel() : nullptr;
+	if (!level) {
+		return;
+	}
+
+	SpawnPoints.Reset();
+	Powerups.Reset();
+	for (AActor* actor : level->Actors) {
+		if (APlayerStart* start = Cast<APlayerStart>(actor)) {
+			SpawnPoints.Add(start);
+		}
+		else if (APowerup* powerup = Cast<APowerup>(actor)) {
+			powerup->ArenaIndex = ArenaIndex;
+			Powerups.Add(powerup);
+		}
+	}
+
+	UE_LOG(LogBlackout, Log, TEXT("Arena %d ready: %s at %s, %d spawn points, %d powerups"),
+		ArenaIndex, *LevelName, *Origin.ToString(), SpawnPoints.Num(), Powerups.Num());
+}
+
+APlayerStart* ABlackoutArena::ChooseSpawnPoint(const FRandomStream& random) const
+{
+	if (SpawnPoints.Num() == 0) {
+		return nullptr;
+	}
+	return SpawnPoints[random.RandRange(0, SpawnPoints.Num() - 1)];
+}
+
+int32 ABlackoutArena::GetViewerArenaIndex(const AActor* RealViewer, const AActor* ViewTarget)
+{
+	// The assignment lives on the player state, so a viewer between pawns or spectating keeps its arena
+	const APlayerState* playerState = nullptr;
+	if (const AController* controller = Cast<AController>(RealViewer)) {
+		playerState = controller->PlayerState;
+	}
+	else if (const APawn* pawn = Cast<APawn>(RealViewer)) {
+		playerState = pawn->GetPlayerState();
+	}
+	const ABlackoutPlayerState* blackoutState = Cast<ABlackoutPlayerState>(playerState);
+	return blackoutState ? blackoutState->ArenaIndex : INDEX_NONE;
+}
+
+bool ABlackoutArena::IsInViewerArena(int32 actorArena, const AActor* RealViewer, const AActor* ViewTarget)
+{
+	// A viewer that hasn't been assigned an arena sees nothing that belongs to one
+	return actorArena == INDEX_NONE || GetViewerArenaIndex(RealViewer, ViewTarget) == actorArena;
+}
+
+bool ABlackoutArena::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+	return GetViewerArenaIndex(RealViewer, ViewTarget) == ArenaIndex;
+}
+
+void ABlackoutArena::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// These never change after Init, only the initial bunch needs them
+	DOREPLIFETIME_CONDITION(ABlackoutArena, ArenaIndex, COND_InitialOnly);
+	DOREPLIFETIME_CONDITION(ABlackoutArena, LevelName, COND_InitialOnly);
+	DOREPLIFETIME_CONDITION(ABlackoutArena, Origin, COND_InitialOnly);
+	DOREPLIFETIME(ABlackoutArena, KillFeed);
+}
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "BlackoutKillFeed.h"
+#include "BlackoutArena.generated.h"
+
+class ULevelStreamingDynamic;
+class APlayerStart;
+class APowerup;
+
+/**
+ * One isolated match hosted inside a shared world. Each arena streams in its own offset instance of a
+ * map (Zap, Maze, ...) and owns the player starts and powerups that came with it.
+ * The actor is only relevant to players in the same arena, so clients only ever load their own arena.
+ */
+UCLASS()
+class BLACKOUT_API ABlackoutArena : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	ABlackoutArena();
+
+	/** Sets up the arena. Must be called on the server before the arena's BeginPlay. */
+	void Init(int32 index, const FString& levelName, const FVector& origin);
+
+	/** Picks a random player start inside this arena, or null if the arena has not finished loading. */
+	APlayerStart* ChooseSpawnPoint(const FRandomStream& random) const;
+
+	/** Index of this arena in the game mode's arena list */
+	FORCEINLINE int32 GetArenaIndex() const { return ArenaIndex; }
+
+	/** Recent kills in this arena, only replicated to its own players */
+	UPROPERTY(Replicated)
+	FBlackoutKillFeed KillFeed;
+
+	/** Number of players currently assigned to this arena. Server only. */
+	UPROPERTY(VisibleInstanceOnly, Category = "Arena")
+	int32 NumPlayers = 0;
+
+	/**
+	 * Returns the arena of whoever is looking at an actor during relevancy checks, from the viewer's
+	 * ABlackoutPlayerState, or INDEX_NONE if the viewer has not been assigned one.
+	 */
+	static int32 GetViewerArenaIndex(const AActor* RealViewer, const AActor* ViewTarget);
+
+	/**
+	 * True if an actor in `actorArena` should be replicated to the given viewer. Actors outside any arena are shared,
+	 * a viewer without an arena sees none of the rest.
+	 */
+	static bool IsInViewerArena(int32 actorArena, const AActor* RealViewer, const AActor* ViewTarget);
+
+	bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
+	void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+protected:
+	void BeginPlay() override;
+	void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	/** Streams in the arena's level instance. Runs on the server and on clients in this arena. */
+	void LoadLevelInstance();
+
+	/** Called once the level instance is visible, gathers the spawn points and powerups that came with it. */
+	UFUNCTION()
+	void OnLevelShown();
+
+	UPROPERTY(Replicated)
+	int32 ArenaIndex = INDEX_NONE;
+
+	/** Long package name of the map this arena is an instance of */
+	UPROPERTY(Replicated)
+	FString LevelName;
+
+	/** World offset of the level instance */
+	UPROPERTY(Replicated)
+	FVector Origin;
+
+	UPROPERTY()
+	ULevelStreamingDynamic* LevelInstance;
+
+	UPROPERTY()
+	TArray<APlayerStart*> SpawnPoints;
+
+	UPROPERTY()
+	TArray<APowerup*> Powerups;
+};
@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutArenaGameMode.h"
+#include "Blackout.h"
+#include "BlackoutArena.h"
+#include "BlackoutCharacter.h"
+#include "BlackoutPlayerState.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerStart.h"
+#include "Kismet/GameplayStatics.h"
+
+ABlackoutArenaGameMode::ABlackoutArenaGameMode()
+	: Super()
+{
+	ArenaMaps.Add(TEXT("/Game/FirstPersonCPP/Maps/Zap"));
+	ArenaMaps.Add(TEXT("/Game/FirstPersonCPP/Maps/Maze"));
+	NumArenas = 4;
+	PlayersPerArena = 8;
+	ArenaSpacing = FVector(200000.f, 0.f, 0.f);
+}
+
+void ABlackoutArenaGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	NumArenas = FMath::Max(1, UGameplayStatics::GetIntOption(Options, TEXT("Arenas"), NumArenas));
+	spectatorArena = FMath::Clamp(UGameplayStatics::GetIntOption(Options, TEXT("SpectatorArena"), 0), 0, NumArenas - 1);
+	if (ArenaMaps.Num() == 0) {
+		ErrorMessage = TEXT("ABlackoutArenaGameMode has no ArenaMaps configured");
+		return;
+	}
+
+	UWorld* world = GetWorld();
+	for (int32 i = 0; i < NumArenas; i++) {
+		ABlackoutArena* arena = world->SpawnActorDeferred<ABlackoutArena>(ABlackoutArena::StaticClass(), FTransform::Identity);
+		arena->Init(i, ArenaMaps[i % ArenaMaps.Num()], ArenaSpacing * i);
+		UGameplayStatics::FinishSpawningActor(arena, FTransform(ArenaSpacing * i));
+		Arenas.Add(arena);
+	}
+
+	UE_LOG(LogBlackout, Log, TEXT("Hosting %d arenas of %d players"), NumArenas, PlayersPerArena);
+}
+
+FString ABlackoutArenaGameMode::InitNewPlayer(APlayerController* NewPlayerController, const FUniqueNetIdRepl& UniqueId, const FString& Options, const FString& Portal)
+{
+	// Fill the emptiest arena so matches start with players spread out
+	ABlackoutArena* best = nullptr;
+	for (ABlackoutArena* arena : Arenas) {
+		if (arena->NumPlayers < PlayersPerArena && (!best || arena->NumPlayers < best->NumPlayers)) {
+			best = arena;
+		}
+	}
+	if (!best) {
+		return TEXT("All arenas are full");
+	}
+
+	// Assigned before Super, which picks the player start through GetArenaFor, but only counted once the player is in
+	Assignments.Add(NewPlayerController, best);
+	const FString error = Super::InitNewPlayer(NewPlayerController, UniqueId, Options, Portal);
+	if (!error.IsEmpty()) {
+		Assignments.Remove(NewPlayerController);
+		return error;
+	}
+	best->NumPlayers++;
+	if (ABlackoutPlayerState* playerState = NewPlayerController->GetPlayerState<ABlackoutPlayerState>()) {
+		playerState->ArenaIndex = best->GetArenaIndex();
+	}
+	return error;
+}
+
+void ABlackoutArenaGameMode::Logout(AController* Exiting)
+{
+	ABlackoutArena* arena = nullptr;
+	if (Assignments.RemoveAndCopyValue(Exiting, arena) && arena) {
+		arena->NumPlayers--;
+	}
+	if (ABlackoutPlayerState* playerState = Exiting->GetPlayerState<ABlackoutPlayerState>()) {
+		playerState->ArenaIndex = INDEX_NONE;
+	}
+	Super::Logout(Exiting);
+}
+
+int32 ABlackoutArenaGameMode::GetMaxPlayers() const
+{
+	return Arenas.Num() * PlayersPerArena;
+}
+
+ABlackoutArena* ABlackoutArenaGameMode::GetArenaFor(const AController* controller) const
+{
+	ABlackoutArena* const* arena = Assignments.Find(controller);
+	return arena ? *arena : nullptr;
+}
+
+AActor* ABlackoutArenaGameMode::ChoosePlayerStart_Implementation(AController* Player)
+{
+	if (ABlackoutArena* arena = GetArenaFor(Player)) {
+		if (APlayerStart* start = arena->ChooseSpawnPoint(GetGameplayRandom())) {
+			return start;
+		}
+		UE_LOG(LogBlackout, Warning, TEXT("Arena %d has no spawn points yet"), arena->GetArenaIndex());
+	}
+	return Super::ChoosePlayerStart_Implementation(Player);
+}
+
+void ABlackoutArenaGameMode::SetPlayerDefaults(APawn* PlayerPawn)
+{
+	Super::SetPlayerDefaults(PlayerPawn);
+
+	if (ABlackoutCharacter* character = Cast<ABlackoutCharacter>(PlayerPawn)) {
+		ABlackoutArena* arena = GetArenaFor(PlayerPawn->GetController());
+		character->ArenaIndex = arena ? arena->GetArenaIndex() : INDEX_NONE;
+	}
+}
+
+AActor* ABlackoutArenaGameMode::ChooseRespawnPoint(ABlackoutCharacter* pawn)
+{
+	if (ABlackoutArena* arena = GetArenaFor(pawn->GetController())) {
+		return arena->ChooseSpawnPoint(GetGameplayRandom());
+	}
+	return Super::ChooseRespawnPoint(pawn);
+}
+
+void ABlackoutArenaGameMode::AnnounceKill(AController* victim, const FString& killerName, const FString& victimName)
+{
+	ABlackoutArena* arena = GetArenaFor(victim);
+	if (!arena) {
+		Super::AnnounceKill(victim, killerName, victimName);
+		return;
+	}
+	// Other arenas never hear about it, the arena actor is only relevant to its own players
+	arena->KillFeed.AddKill(killerName, victimName);
+	arena->ForceNetUpdate();
+}
+
+void ABlackoutArenaGameMode::OnSpectatorBroadcastStarted(APlayerController* recorder)
+{
+	// The recording is relevancy checked like any other viewer, so it only sees the arena it is assigned to
+	if (ABlackoutPlayerState* playerState = recorder->GetPlayerState<ABlackoutPlayerState>()) {
+		playerState->ArenaIndex = spectatorArena;
+		UE_LOG(LogBlackout, Log, TEXT("Spectator broadcast shows arena %d"), spectatorArena);
+	}
+}
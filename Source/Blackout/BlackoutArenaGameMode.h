@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BlackoutGameMode.h"
+#include "BlackoutArenaGameMode.generated.h"
+
+class ABlackoutArena;
+
+/**
+ * Hosts several small, isolated matches in one world. Every arena is an offset instance of one of ArenaMaps,
+ * with its own spawn points, powerups and relevancy scope, so one server process can run many matches
+ * while sharing loaded assets and engine overhead.
+ *
+ * Load an empty persistent map with ?game=/Script/Blackout.BlackoutArenaGameMode, optionally with ?Arenas=N.
+ * ?SpectatorBroadcast= broadcasts one arena, picked with ?SpectatorArena=N.
+ */
+UCLASS(config=Game)
+class BLACKOUT_API ABlackoutArenaGameMode : public ABlackoutGameMode
+{
+	GENERATED_BODY()
+
+public:
+	ABlackoutArenaGameMode();
+
+	void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+	FString InitNewPlayer(APlayerController* NewPlayerController, const FUniqueNetIdRepl& UniqueId, const FString& Options, const FString& Portal) override;
+	void Logout(AController* Exiting) override;
+	AActor* ChoosePlayerStart_Implementation(AController* Player) override;
+	void SetPlayerDefaults(APawn* PlayerPawn) override;
+	int32 GetMaxPlayers() const override;
+
+	/** Returns the arena a controller has been assigned to, or null */
+	ABlackoutArena* GetArenaFor(const AController* controller) const;
+
+	/** Maps the arenas are instanced from, used round-robin */
+	UPROPERTY(Config, EditAnywhere, Category = "Arena")
+	TArray<FString> ArenaMaps;
+
+	/** Number of arenas to create. Can be overridden with ?Arenas=N */
+	UPROPERTY(Config, EditAnywhere, Category = "Arena")
+	int32 NumArenas;
+
+	/** Players per arena. Logins beyond NumArenas * PlayersPerArena are rejected. */
+	UPROPERTY(Config, EditAnywhere, Category = "Arena")
+	int32 PlayersPerArena;
+
+	/** Offset between the origins of neighbouring arenas. Must be larger than any arena map. */
+	UPROPERTY(Config, EditAnywhere, Category = "Arena")
+	FVector ArenaSpacing;
+
+protected:
+	AActor* ChooseRespawnPoint(ABlackoutCharacter* pawn) override;
+	void AnnounceKill(AController* victim, const FString& killerName, const FString& victimName) override;
+	void OnSpectatorBroadcastStarted(APlayerController* recorder) override;
+
+private:
+	UPROPERTY()
+	TArray<ABlackoutArena*> Arenas;
+
+	/** Arena the spectator broadcast shows, from ?SpectatorArena=. Arenas are isolated, so a broadcast shows one. */
+	int32 spectatorArena = 0;
+
+	/** Which arena each logged in player belongs to */
+	UPROPERTY()
+	TMap<AController*, ABlackoutArena*> Assignments;
+};
@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutBeaconClient.h"
+#include "Blackout.h"
+#include "BlackoutBeaconHostObject.h"
+#include "BlackoutStats.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Guid.h"
+#include "Misc/Parse.h"
+
+/** The servers asked by the last Blackout.Query, timed as one batch */
+struct FBlackoutQueryBatch
+{
+	double Start = 0;
+	int32 Pending = 0;
+	int32 Answered = 0;
+	TArray<float> PingsMs;
+};
+static FBlackoutQueryBatch QueryBatch;
+
+static void FinishQuery(bool answered, float pingMs)
+{
+	if (answered) {
+		QueryBatch.Answered++;
+		QueryBatch.PingsMs.Add(pingMs);
+	}
+	if (--QueryBatch.Pending > 0) {
+		return;
+	}
+	UE_LOG(LogBlackout, Display, TEXT("Beacon query: %d servers answered in %.1f ms, ping %s"),
+		QueryBatch.Answered, (FPlatformTime::Seconds() - QueryBatch.Start) * 1000.0, *BlackoutStats::FormatPercentiles(QueryBatch.PingsMs));
+
+	// Lets Scripts/BeaconQueryTest.sh run a query and collect the result
+	if (FParse::Param(FCommandLine::Get(), TEXT("BeaconQueryExit"))) {
+		FPlatformMisc::RequestExitWithStatus(false, QueryBatch.Answered > 0 ? 0 : 1);
+	}
+}
+
+/** Blackout.Query <host:beaconport>... */
+static FAutoConsoleCommandWithWorldAndArgs QueryCommand(
+	TEXT("Blackout.Query"),
+	TEXT("Asks servers for their map, players and ping over beacons, without joining. Usage: Blackout.Query <host:beaconport>..."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (!World || Args.Num() == 0) {
+			UE_LOG(LogBlackout, Warning, TEXT("Usage: Blackout.Query <host:beaconport>..."));
+			return;
+		}
+		QueryBatch = FBlackoutQueryBatch();
+		QueryBatch.Start = FPlatformTime::Seconds();
+		QueryBatch.Pending = Args.Num();
+		for (const FString& address : Args) {
+			if (!ABlackoutBeaconClient::Connect(World, address, false)) {
+				FinishQuery(false, 0.f);
+			}
+		}
+	}));
+
+/** Blackout.Reserve <host:beaconport> */
+static FAutoConsoleCommandWithWorldAndArgs ReserveCommand(
+	TEXT("Blackout.Reserve"),
+	TEXT("Reserves a slot on a server over its beacon, then joins it. Usage: Blackout.Reserve <host:beaconport>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (!World || Args.Num() != 1) {
+			UE_LOG(LogBlackout, Warning, TEXT("Usage: Blackout.Reserve <host:beaconport>"));
+			return;
+		}
+		ABlackoutBeaconClient::Connect(World, Args[0], true);
+	}));
+
+ABlackoutBeaconClient* ABlackoutBeaconClient::Connect(UWorld* world, const FString& address, bool reserve)
+{
+	ABlackoutBeaconClient* client = world->SpawnActor<ABlackoutBeaconClient>();
+	if (!client) {
+		return nullptr;
+	}
+	client->address = address;
+	client->reserve = reserve;
+
+	FURL url(nullptr, *address, TRAVEL_Absolute);
+	if (!client->InitClient(url)) {
+		UE_LOG(LogBlackout, Warning, TEXT("Beacon: could not connect to %s"), *address);
+		client->Destroy();
+		return nullptr;
+	}
+	return client;
+}
+
+void ABlackoutBeaconClient::OnConnected()
+{
+	Super::OnConnected();
+	requestTime = FPlatformTime::Seconds();
+	if (reserve) {
+		reservationId = FGuid::NewGuid().ToString();
+		ServerReserve(reservationId);
+	}
+	else {
+		ServerQuery();
+	}
+}
+
+void ABlackoutBeaconClient::OnFailure()
+{
+	UE_LOG(LogBlackout, Warning, TEXT("Beacon: %s did not answer"), *address);
+	if (!reserve) {
+		FinishQuery(false, 0.f);
+	}
+	Super::OnFailure();
+}
+
+bool ABlackoutBeaconClient::ServerQuery_Validate()
+{
+	return true;
+}
+
+void ABlackoutBeaconClient::ServerQuery_Implementation()
+{
+	if (ABlackoutBeaconHostObject* host = Cast<ABlackoutBeaconHostObject>(GetBeaconOwner())) {
+		ClientQueryResult(host->GetServerInfo());
+	}
+}
+
+void ABlackoutBeaconClient::ClientQueryResult_Implementation(const FBlackoutServerInfo& info)
+{
+	// Round trip of the query itself, the connection handshake is not counted
+	const float pingMs = (FPlatformTime::Seconds() - requestTime) * 1000.0;
+	UE_LOG(LogBlackout, Display, TEXT("  %-24s %-12s %2d/%2d players, %d reserved, %.0f ms"),
+		*address, *info.MapName, info.NumPlayers, info.MaxPlayers, info.NumReservations, pingMs);
+	FinishQuery(true, pingMs);
+	DestroyBeacon();
+}
+
+bool ABlackoutBeaconClient::ServerReserve_Validate(const FString& id)
+{
+	return id.Len() <= 64;
+}
+
+void ABlackoutBeaconClient::ServerReserve_Implementation(const FString& id)
+{
+	if (ABlackoutBeaconHostObject* host = Cast<ABlackoutBeaconHostObject>(GetBeaconOwner())) {
+		const bool success = host->Reserve(GetNetConnection(), id);
+		ClientReserveResult(success, host->GetServerInfo());
+	}
+}
+
+void ABlackoutBeaconClient::ClientReserveResult_Implementation(bool success, const FBlackoutServerInfo& info)
+{
+	if (!success) {
+		UE_LOG(LogBlackout, Display, TEXT("Beacon: %s is full (%d/%d players, %d reserved)"), *address, info.NumPlayers, info.MaxPlayers, info.NumReservations);
+		DestroyBeacon();
+		return;
+	}
+
+	FString host = address;
+	address.Split(TEXT(":"), &host, nullptr);
+	const FString travelUrl = FString::Printf(TEXT("%s:%d?Reservation=%s"), *host, info.GamePort, *reservationId);
+	UE_LOG(LogBlackout, Display, TEXT("Beacon: reserved a slot on %s, joining %s"), *address, *travelUrl);
+	if (APlayerController* playerController = GetWorld()->GetFirstPlayerController()) {
+		playerController->ClientTravel(travelUrl, TRAVEL_Absolute);
+	}
+	DestroyBeacon();
+}
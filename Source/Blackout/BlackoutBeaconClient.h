@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineBeaconClient.h"
+#include "BlackoutBeaconClient.generated.h"
+
+/** What a server reports about itself to a beacon query */
+USTRUCT()
+struct FBlackoutServerInfo
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FString MapName;
+
+	/** Port of the game itself, to travel to after a reservation */
+	UPROPERTY()
+	int32 GamePort = 0;
+
+	UPROPERTY()
+	int32 NumPlayers = 0;
+
+	/** Slots held by reservations that have not joined yet */
+	UPROPERTY()
+	int32 NumReservations = 0;
+
+	UPROPERTY()
+	int32 MaxPlayers = 0;
+};
+
+/**
+ * Client side of the Blackout beacon: asks a server for its map, capacity and ping, or reserves a slot, over a
+ * beacon connection that loads no map and creates no pawn. See ABlackoutBeaconHostObject.
+ *
+ * `Blackout.Query <host:beaconport>...` queries any number of servers at once and logs how long they all took.
+ * `Blackout.Reserve <host:beaconport>` reserves a slot and then joins the server with it.
+ */
+UCLASS(transient, notplaceable)
+class BLACKOUT_API ABlackoutBeaconClient : public AOnlineBeaconClient
+{
+	GENERATED_BODY()
+
+public:
+	/** Connects to `address` and queries it, or reserves a slot if `reserve` is set */
+	static ABlackoutBeaconClient* Connect(UWorld* world, const FString& address, bool reserve);
+
+	void OnConnected() override;
+	void OnFailure() override;
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerQuery();
+
+	UFUNCTION(Client, Reliable)
+	void ClientQueryResult(const FBlackoutServerInfo& info);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerReserve(const FString& id);
+
+	UFUNCTION(Client, Reliable)
+	void ClientReserveResult(bool success, const FBlackoutServerInfo& info);
+
+private:
+	FString address;
+	bool reserve = false;
+	FString reservationId;
+
+	/** When the query or reservation was sent, for the ping */
+	double requestTime = 0;
+};
@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutBeaconHostObject.h"
+#include "Blackout.h"
+#include "BlackoutGameMode.h"
+#include "Engine/NetConnection.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+#include "OnlineBeaconHost.h"
+
+ABlackoutBeaconHostObject::ABlackoutBeaconHostObject()
+{
+	ClientBeaconActorClass = ABlackoutBeaconClient::StaticClass();
+	BeaconTypeName = ClientBeaconActorClass->GetName();
+	ReservationSeconds = 30.f;
+}
+
+ABlackoutBeaconHostObject* ABlackoutBeaconHostObject::StartHost(UWorld* world)
+{
+	AOnlineBeaconHost* host = world->SpawnActor<AOnlineBeaconHost>();
+	if (!host || !host->InitHost()) {
+		UE_LOG(LogBlackout, Warning, TEXT("Beacon host could not be started"));
+		if (host) {
+			host->Destroy();
+		}
+		return nullptr;
+	}
+
+	ABlackoutBeaconHostObject* hostObject = world->SpawnActor<ABlackoutBeaconHostObject>();
+	host->RegisterHost(hostObject);
+	host->PauseBeaconRequests(false);
+	UE_LOG(LogBlackout, Log, TEXT("Beacon host listening on port %d"), host->GetListenPort());
+	return hostObject;
+}
+
+FBlackoutServerInfo ABlackoutBeaconHostObject::GetServerInfo()
+{
+	ExpireReservations();
+
+	FBlackoutServerInfo info;
+	info.MapName = UGameplayStatics::GetCurrentLevelName(this, true);
+	info.GamePort = GetWorld()->URL.Port;
+	info.NumReservations = reservations.Num();
+	if (ABlackoutGameMode* gameMode = GetWorld()->GetAuthGameMode<ABlackoutGameMode>()) {
+		info.NumPlayers = gameMode->GetNumPlayers();
+		info.MaxPlayers = gameMode->GetMaxPlayers();
+	}
+	return info;
+}
+
+bool ABlackoutBeaconHostObject::Reserve(UNetConnection* connection, const FString& reservationId)
+{
+	if (!connection || reservationId.IsEmpty()) {
+		return false;
+	}
+	const FBlackoutServerInfo info = GetServerInfo();
+	// A renewal, or another reservation from a connection that already has one
+	if (const FString* held = connectionReservations.Find(connection)) {
+		if (*held != reservationId) {
+			UE_LOG(LogBlackout, Warning, TEXT("Beacon: %s asked for a second reservation"), *connection->LowLevelGetRemoteAddress(true));
+			return false;
+		}
+	}
+	else if (reservations.Contains(reservationId) || info.NumPlayers + info.NumReservations >= info.MaxPlayers) {
+		return false;
+	}
+	reservations.Add(reservationId, FPlatformTime::Seconds() + ReservationSeconds);
+	connectionReservations.Add(connection, reservationId);
+	return true;
+}
+
+bool ABlackoutBeaconHostObject::AdmitPlayer(const FString& reservationId)
+{
+	const FBlackoutServerInfo info = GetServerInfo();
+	if (!reservationId.IsEmpty() && reservations.Contains(reservationId)) {
+		return true;
+	}
+	return info.NumPlayers + info.NumReservations < info.MaxPlayers;
+}
+
+void ABlackoutBeaconHostObject::ConsumeReservation(const FString& reservationId)
+{
+	if (!reservationId.IsEmpty()) {
+		reservations.Remove(reservationId);
+	}
+}
+
+void ABlackoutBeaconHostObject::ExpireReservations()
+{
+	const double now = FPlatformTime::Seconds();
+	for (auto it = reservations.CreateIterator(); it; ++it) {
+		if (it.Value() < now) {
+			it.RemoveCurrent();
+		}
+	}
+	for (auto it = connectionReservations.CreateIterator(); it; ++it) {
+		if (!it.Key().IsValid()) {
+			it.RemoveCurrent();
+		}
+	}
+}
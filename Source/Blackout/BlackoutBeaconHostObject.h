@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineBeaconHostObject.h"
+#include "BlackoutBeaconClient.h"
+#include "BlackoutBeaconHostObject.generated.h"
+
+class AOnlineBeaconHost;
+class UNetConnection;
+
+/**
+ * Server side of the Blackout beacon. Answers capacity and map queries and hands out short-lived slot
+ * reservations, one per beacon connection, which ABlackoutGameMode::PreLogin honours. Started by the game mode on servers, listening on
+ * the OnlineBeaconHost ListenPort (-BeaconPort=N to run several servers on one machine).
+ */
+UCLASS(config=Game, transient, notplaceable)
+class BLACKOUT_API ABlackoutBeaconHostObject : public AOnlineBeaconHostObject
+{
+	GENERATED_BODY()
+
+public:
+	ABlackoutBeaconHostObject();
+
+	/** Starts listening for beacons in the world. Returns null if the beacon host could not be started. */
+	static ABlackoutBeaconHostObject* StartHost(UWorld* world);
+
+	FBlackoutServerInfo GetServerInfo();
+
+	/**
+	 * Tries to hold a slot for `reservationId`, made over the beacon `connection`. Each connection only ever gets one
+	 * reservation: renewing it always succeeds, asking for another fails.
+	 */
+	bool Reserve(UNetConnection* connection, const FString& reservationId);
+
+	/**
+	 * Decides whether a player joining with the given reservation (empty if none) may take a slot. Unreserved players
+	 * only get slots nobody holds. The reservation keeps holding the slot until ConsumeReservation.
+	 */
+	bool AdmitPlayer(const FString& reservationId);
+
+	/** Frees the reservation of a player who has now taken their slot */
+	void ConsumeReservation(const FString& reservationId);
+
+	/** Reservations held, including ones that have expired but not been forgotten yet */
+	FORCEINLINE int32 GetReservationCount() const { return reservations.Num(); }
+
+	/** How long a reservation holds a slot for its player to join */
+	UPROPERTY(Config)
+	float ReservationSeconds;
+
+private:
+	/** Forgets reservations whose player never showed up */
+	void ExpireReservations();
+
+	/** Reservation id to when it expires, in real seconds */
+	TMap<FString, double> reservations;
+
+	/** Beacon connection to the one reservation it made, forgotten when the connection goes away */
+	TMap<TWeakObjectPtr<UNetConnection>, FString> connectionReservations;
+};
@@ -3,7 +3,9 @@
 #include "BlackoutCharacter.h"
 #include "BlackoutProjectile.h"
 #include "Animation/AnimInstance.h"
+#include "AnimationRuntime.h"
 #include "Camera/CameraComponent.h"
+#include "Engine/SkeletalMeshSocket.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/InputComponent.h"
 #include "GameFramework/InputSettings.h"
@@ -16,8 +18,23 @@
 #include "Net/UnrealNetwork.h"
 #include "Engine/Engine.h"
 #include "BlackoutGameMode.h"
+#include "BlackoutArena.h"
+#include "BlackoutFireTrace.h"
+#include "BlackoutAnimationBudget.h"
+#include "BlackoutCharacterMovementComponent.h"
+#include "BlackoutPlayerState.h"
+#include "BlackoutPlayerController.h"
+#include "BlackoutServerGovernor.h"
+#include "BlackoutMemory.h"
+#include "BlackoutSplitscreen.h"
+#include "BlackoutInputRecorder.h"
+#include "BlackoutLoadGenerator.h"
 #include "BlackoutHud.h"
 #include "GameFramework/GameModeBase.h"
+#include "Blackout.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
 
 
 DEFINE_LOG_CATEGORY_STATIC(LogFPChar, Warning, All);
@@ -25,8 +42,10 @@ DEFINE_LOG_CATEGORY_STATIC(LogFPChar, Warning, All);
 //////////////////////////////////////////////////////////////////////////
 // ABlackoutCharacter
 
-ABlackoutCharacter::ABlackoutCharacter()
+ABlackoutCharacter::ABlackoutCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UBlackoutCharacterMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
+	BLACKOUT_LLM_SCOPE(Characters);
 
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(55.f, 96.0f);
@@ -42,6 +61,7 @@ ABlackoutCharacter::ABlackoutCharacter()
 	FirstPersonCameraComponent->SetupAttachment(GetCapsuleComponent());
 	FirstPersonCameraComponent->SetRelativeLocation(FVector(-39.56f, 1.75f, 64.f)); // Position the camera
 	FirstPersonCameraComponent->bUsePawnControlRotation = true;
+	FirstPersonCameraComponent->bAutoRegister = false;	// See UpdateFirstPersonComponents
 
 	// Create a mesh component that will be used when being viewed from a '1st person' view (when controlling this pawn)
 	Mesh1P = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("CharacterMesh1P"));
@@ -51,6 +71,7 @@ ABlackoutCharacter::ABlackoutCharacter()
 	Mesh1P->CastShadow = false;
 	Mesh1P->SetRelativeRotation(FRotator(1.9f, -19.19f, 5.2f));
 	Mesh1P->SetRelativeLocation(FVector(-0.5f, -4.4f, -155.7f));
+	Mesh1P->bAutoRegister = false;
 
 	// Create a gun mesh component
 	FP_Gun = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("FP_Gun"));
@@ -59,10 +80,12 @@ ABlackoutCharacter::ABlackoutCharacter()
 	FP_Gun->CastShadow = false;
 	// FP_Gun->SetupAttachment(Mesh1P, TEXT("GripPoint"));
 	FP_Gun->SetupAttachment(RootComponent);
+	FP_Gun->bAutoRegister = false;
 
 	FP_MuzzleLocation = CreateDefaultSubobject<USceneComponent>(TEXT("MuzzleLocation"));
 	FP_MuzzleLocation->SetupAttachment(FP_Gun);
 	FP_MuzzleLocation->SetRelativeLocation(FVector(0.2f, 48.4f, -10.6f));
+	FP_MuzzleLocation->bAutoRegister = false;
 
 	// Default offset from the character location for projectiles to spawn
 	GunOffset = FVector(100.0f, 0.0f, 10.0f);
@@ -77,6 +100,7 @@ ABlackoutCharacter::ABlackoutCharacter()
 	PersonalLight->SetAttenuationRadius(400.f);
 	PersonalLight->SetupAttachment(RootComponent);
 	PersonalLight->bVisible = true;
+	PersonalLight->bAutoRegister = false;
 
 	// Set default health
 	MaxHealth = 2;
@@ -90,30 +114,38 @@ ABlackoutCharacter::ABlackoutCharacter()
 
 	// Set default sensitivity
 	LookSpeedScaler = 1.f;
+
+	// Owners send moves at no more than MaxMoveSendRate, replicating faster only resends the same position.
+	// Simulated proxies smooth over the gaps, see FBlackoutJitterBuffer.
+	NetUpdateFrequency = 30.f;
+	MinNetUpdateFrequency = 10.f;
 }
 
 void ABlackoutCharacter::BeginPlay()
 {
+	BLACKOUT_LLM_SCOPE(Characters);
 	// Call the base class  
 	Super::BeginPlay();
 
 	// GetCapsuleComponent()->SetGenerateOverlapEvents(true);
 
-	//Attach gun mesh component to Skeleton, doing it here because the skeleton is not yet created in the constructor
-	FP_Gun->AttachToComponent(Mesh1P, FAttachmentTransformRules(EAttachmentRule::SnapToTarget, true), TEXT("GripPoint"));
+	// Nobody ever sees a light on a dedicated server or a headless load client
+	if (IsRunningDedicatedServer() || FBlackoutLoadGenerator::IsHeadless()) {
+		PersonalLight->DestroyComponent();
+		PersonalLight = nullptr;
+	}
 
+	ConfigureAnimationBudget();
+	UpdateMuzzleOffset();
 
-	// Disable every else's flashlight
-	if (!IsLocallyControlled()) {
-		// The code here only runs on the computer which owns this actor (the computer of the player controlling this character)
-		PersonalLight->SetHiddenInGame(true);
-	}
+	// Only bring up the first person components if this is our pawn. If it isn't yet, PossessedBy or
+	// PawnClientRestart will do it once the controller arrives.
+	UpdateFirstPersonComponents();
 
-	// Set up a time manager.
-	UWorld* world = GetWorld();
-	if (world) {
-		// For some reason GetWorld() can return null, so we had better check for it so we don't get a seg-fault. We have to do that alot in this code
-		world->GetTimerManager().SetTimer(footstepHandler, this, &ABlackoutCharacter::OnFootstep, footStepRate, true);
+	// Set up a time manager. Footsteps are only sounds, which dedicated servers and headless load clients don't play.
+	ABlackoutScheduler* scheduler = IsRunningDedicatedServer() || FBlackoutLoadGenerator::IsHeadless() ? nullptr : ABlackoutScheduler::Get(this);
+	if (scheduler) {
+		footstepTimer = scheduler->SetTimer(EBlackoutTimerCategory::Footsteps, FSimpleDelegate::CreateUObject(this, &ABlackoutCharacter::OnFootstep), footStepRate, true);
 	}
 	
 	// Start player with 6 clips
@@ -123,6 +155,142 @@ void ABlackoutCharacter::BeginPlay()
 	OnHealthUpdate();
 }
 
+void ABlackoutCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ABlackoutScheduler::Cancel(this, footstepTimer);
+	if (ABlackoutAnimationBudget* budget = animationBudget.Get()) {
+		budget->Unregister(this);
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+void ABlackoutCharacter::ConfigureAnimationBudget()
+{
+	USkeletalMeshComponent* mesh = GetMesh();
+	if (GetNetMode() == NM_DedicatedServer || FBlackoutLoadGenerator::IsHeadless()) {
+		// Hits are against the capsule, nothing on the server needs the third person pose. Montages still run so
+		// notifies fire.
+		mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+		return;
+	}
+
+	// Remote characters only animate when seen, and at a rate the budget can afford.
+	// Our own pawn is skipped by the budget once its controller arrives.
+	mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+	mesh->bEnableUpdateRateOptimizations = true;
+	if (ABlackoutAnimationBudget* budget = ABlackoutAnimationBudget::Get(GetWorld())) {
+		budget->Register(this);
+		animationBudget = budget;
+	}
+}
+
+void ABlackoutCharacter::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+	UpdateFirstPersonComponents();
+}
+
+void ABlackoutCharacter::PawnClientRestart()
+{
+	Super::PawnClientRestart();
+	UpdateFirstPersonComponents();
+}
+
+DECLARE_CYCLE_STAT(TEXT("First person component registration"), STAT_FirstPersonRegistration, STATGROUP_Blackout);
+
+/** Total time spent in UpdateFirstPersonComponents, reported by Blackout.Character.ComponentReport */
+static double GFirstPersonRegistrationSeconds = 0;
+
+/** Registers or unregisters a component, doing nothing if it is already in the requested state */
+static void SetComponentRegistered(UActorComponent* component, bool registered)
+{
+	if (component == nullptr) {
+		return;
+	}
+	if (registered && !component->IsRegistered()) {
+		component->RegisterComponent();
+	}
+	else if (!registered && component->IsRegistered()) {
+		component->UnregisterComponent();
+	}
+}
+
+void ABlackoutCharacter::UpdateFirstPersonComponents()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FirstPersonRegistration);
+	BLACKOUT_LLM_SCOPE(Characters);
+	const double start = FPlatformTime::Seconds();
+
+	// Only the owner sees them. The server poses the gun for GetMuzzleLocation until the gun's offset is measured.
+	const bool local = IsLocallyControlled();
+	const bool serverPosed = HasAuthority() && !hasMeasuredMuzzle;
+	// Headless load clients still aim through the camera, but have no arms or gun to show
+	const bool meshes = (local && !FBlackoutLoadGenerator::IsHeadless()) || serverPosed;
+
+	// Parents first, so children attach to something that has a transform
+	SetComponentRegistered(FirstPersonCameraComponent, local || serverPosed);
+	SetComponentRegistered(Mesh1P, meshes);
+	SetComponentRegistered(FP_Gun, meshes);
+	SetComponentRegistered(FP_MuzzleLocation, meshes);
+	SetComponentRegistered(PersonalLight, local);
+
+	//Attach gun mesh component to Skeleton, doing it here because the skeleton is not yet created in the constructor
+	if (FP_Gun->IsRegistered() && FP_Gun->GetAttachParent() != Mesh1P) {
+		FP_Gun->AttachToComponent(Mesh1P, FAttachmentTransformRules(EAttachmentRule::SnapToTarget, true), TEXT("GripPoint"));
+	}
+
+	GFirstPersonRegistrationSeconds += FPlatformTime::Seconds() - start;
+}
+
+TArray<UActorComponent*, TInlineAllocator<5>> ABlackoutCharacter::GetFirstPersonComponents() const
+{
+	TArray<UActorComponent*, TInlineAllocator<5>> components;
+	components.Add(FirstPersonCameraComponent);
+	components.Add(Mesh1P);
+	components.Add(FP_Gun);
+	components.Add(FP_MuzzleLocation);
+	components.Add(PersonalLight);
+	components.Remove(nullptr);
+	return components;
+}
+
+/**
+ * Blackout.Character.ComponentReport
+ * Logs how many characters have their first person components registered and how much memory those components
+ * use. Run it with a full lobby on the server and on a client to compare.
+ */
+static FAutoConsoleCommandWithWorld ComponentReportCommand(
+	TEXT("Blackout.Character.ComponentReport"),
+	TEXT("Logs first person component registration and memory for every character"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		int32 characters = 0;
+		int32 registeredCharacters = 0;
+		int64 registeredBytes = 0;
+		int64 unregisteredBytes = 0;
+		for (TActorIterator<ABlackoutCharacter> it(World); it; ++it) {
+			characters++;
+			bool anyRegistered = false;
+			for (UActorComponent* component : it->GetFirstPersonComponents()) {
+				const int64 bytes = component->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+				if (component->IsRegistered()) {
+					anyRegistered = true;
+					registeredBytes += bytes;
+				}
+				else {
+					unregisteredBytes += bytes;
+				}
+			}
+			registeredCharacters += anyRegistered ? 1 : 0;
+		}
+
+		UE_LOG(LogBlackout, Display, TEXT("%d characters, %d with first person components. Registered: %.1f KB (%.1f KB/character), skipped: %.1f KB. Registration time so far: %.3f ms"),
+			characters, registeredCharacters,
+			registeredBytes / 1024.0, registeredBytes / 1024.0 / FMath::Max(1, registeredCharacters),
+			unregisteredBytes / 1024.0, GFirstPersonRegistrationSeconds * 1000.0);
+	})
+);
+
 void ABlackoutCharacter::GetLifetimeReplicatedProps(TArray <FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
@@ -132,6 +300,61 @@ void ABlackoutCharacter::GetLifetimeReplicatedProps(TArray <FLifetimeProperty>&
 	DOREPLIFETIME(ABlackoutCharacter, Ammo);
 }
 
+bool ABlackoutCharacter::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+	// Players in other arenas never see us, which also keeps our multicasts inside the arena.
+	// Within an arena, players in the dark are not sent at all, so there is nothing for a wallhack to show.
+	return ABlackoutArena::IsInViewerArena(ArenaIndex, RealViewer, ViewTarget)
+		&& IsRevealedTo(RealViewer, ViewTarget, SrcLocation)
+		&& Super::IsNetRelevantFor(RealViewer, ViewTarget, SrcLocation);
+}
+
+bool ABlackoutCharacter::IsReplayRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation, const float CullDistanceSquared) const
+{
+	// Spectator broadcasts show everyone in their arena, darkness only hides players from other players
+	return ABlackoutArena::IsInViewerArena(ArenaIndex, RealViewer, ViewTarget)
+		&& Super::IsNetRelevantFor(RealViewer, ViewTarget, SrcLocation);
+}
+
+float ABlackoutCharacter::GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth)
+{
+	float priority = Super::GetNetPriority(ViewPos, ViewDir, Viewer, ViewTarget, InChannel, Time, bLowBandwidth);
+
+	// Still relevant but no longer visible (the engine keeps channels open for a while), send updates less often
+	ABlackoutGameMode* gameMode = GetWorld()->GetAuthGameMode<ABlackoutGameMode>();
+	if (gameMode && !IsRevealedTo(Viewer, ViewTarget, ViewPos)) {
+		priority *= gameMode->UnrevealedNetPriorityScale;
+	}
+	return priority;
+}
+
+bool ABlackoutCharacter::IsRevealedTo(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+	if (ViewTarget == this || (RealViewer && RealViewer == GetController())) {
+		return true;
+	}
+
+	ABlackoutGameMode* gameMode = GetWorld()->GetAuthGameMode<ABlackoutGameMode>();
+	if (!gameMode) {
+		return true;
+	}
+
+	if (FVector::DistSquared(SrcLocation, GetActorLocation()) <= FMath::Square(gameMode->RevealRadius)) {
+		return true;
+	}
+	return IsLitByProjectile();
+}
+
+bool ABlackoutCharacter::IsLitByProjectile() const
+{
+	if (litFrame != GFrameCounter) {
+		const FBlackoutLightExposureGrid* exposure = ABlackoutGameMode::GetLightExposure(this);
+		bLitByProjectile = exposure && exposure->IsLit(GetActorLocation());
+		litFrame = GFrameCounter;
+	}
+	return bLitByProjectile;
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Input
 
@@ -159,8 +382,8 @@ void ABlackoutCharacter::SetupPlayerInputComponent(class UInputComponent* Player
 	check(PlayerInputComponent);
 
 	// Bind jump events
-	PlayerInputComponent->BindAction("Jump", IE_Pressed, this, &ACharacter::Jump);
-	PlayerInputComponent->BindAction("Jump", IE_Released, this, &ACharacter::StopJumping);
+	PlayerInputComponent->BindAction("Jump", IE_Pressed, this, &ABlackoutCharacter::OnJumpPressed);
+	PlayerInputComponent->BindAction("Jump", IE_Released, this, &ABlackoutCharacter::OnJumpReleased);
 
 	// Bind fire event
 	PlayerInputComponent->BindAction("Fire", IE_Pressed, this, &ABlackoutCharacter::OnFire);
@@ -177,11 +400,53 @@ void ABlackoutCharacter::SetupPlayerInputComponent(class UInputComponent* Player
 	PlayerInputComponent->BindAxis("LookUp", this, &ABlackoutCharacter::LookUp);
 	PlayerInputComponent->BindAxis("LookUpRate", this, &ABlackoutCharacter::LookUpAtRate);
 
-	PlayerInputComponent->BindAction("Pause", IE_Pressed, this, &ABlackoutCharacter::Pause);
+	PlayerInputComponent->BindAction("Pause", IE_Pressed, this, &ABlackoutCharacter::OnPausePressed);
+}
+
+void ABlackoutCharacter::OnJumpPressed()
+{
+	FBlackoutInputRecorder::Get().RecordAction(this, EBlackoutInputAction::JumpPressed);
+	Jump();
+}
+
+void ABlackoutCharacter::OnJumpReleased()
+{
+	FBlackoutInputRecorder::Get().RecordAction(this, EBlackoutInputAction::JumpReleased);
+	StopJumping();
+}
+
+void ABlackoutCharacter::OnPausePressed()
+{
+	FBlackoutInputRecorder::Get().RecordAction(this, EBlackoutInputAction::PausePressed);
+	Pause();
+}
+
+void ABlackoutCharacter::ReplayInput(const FBlackoutInputFrame& frame)
+{
+	// Actions before axes, in the order the input stack calls them
+	if (frame.HasAction(EBlackoutInputAction::JumpPressed)) {
+		OnJumpPressed();
+	}
+	if (frame.HasAction(EBlackoutInputAction::JumpReleased)) {
+		OnJumpReleased();
+	}
+	if (frame.HasAction(EBlackoutInputAction::FirePressed)) {
+		OnFire();
+	}
+	if (frame.HasAction(EBlackoutInputAction::PausePressed)) {
+		OnPausePressed();
+	}
+	MoveForward(frame.Axes[(int32)EBlackoutInputAxis::MoveForward]);
+	MoveRight(frame.Axes[(int32)EBlackoutInputAxis::MoveRight]);
+	Turn(frame.Axes[(int32)EBlackoutInputAxis::Turn]);
+	TurnAtRate(frame.Axes[(int32)EBlackoutInputAxis::TurnRate]);
+	LookUp(frame.Axes[(int32)EBlackoutInputAxis::LookUp]);
+	LookUpAtRate(frame.Axes[(int32)EBlackoutInputAxis::LookUpRate]);
 }
 
 void ABlackoutCharacter::OnFire()
 {
+	FBlackoutInputRecorder::Get().RecordAction(this, EBlackoutInputAction::FirePressed);
 	if (paused) {
 		return;
 	}
@@ -191,7 +456,7 @@ void ABlackoutCharacter::OnFire()
 		return;
 	}
 
-	if (timeSinceLastShot < fireRate) {
+	if (GetWorld()->GetTimeSeconds() < nextShotTime) {
 		// Do nothing if you have shot recently.
 		// GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Blue, TEXT("Can't Shoot"));
 		return;
@@ -201,8 +466,10 @@ void ABlackoutCharacter::OnFire()
 	if (ProjectileClass != NULL)
 	{
 		// We want the actual shot to run on the server, so we call an RPC to run it there.
-		DoFire();
-		timeSinceLastShot = 0;
+		const uint16 traceId = FBlackoutFireTrace::Get().NewTraceId();
+		FBlackoutFireTrace::Get().Record(this, traceId, EBlackoutFireStage::Input);
+		DoFire(traceId);
+		nextShotTime = GetWorld()->GetTimeSeconds() + fireRate;
 	}
 
 	// try and play a firing animation if specified
@@ -217,14 +484,139 @@ void ABlackoutCharacter::OnFire()
 	}
 }
 
-void ABlackoutCharacter::DoFire_Implementation()
+bool ABlackoutCharacter::DoFire_Validate(uint16 traceId)
 {
+	const ABlackoutPlayerController* playerController = Cast<ABlackoutPlayerController>(GetController());
+	return !playerController || !playerController->IsFloodingRpcs();
+}
+
+static TAutoConsoleVariable<int32> CVarMuzzleValidate(
+	TEXT("Blackout.Muzzle.Validate"),
+	0,
+	TEXT("Measure how far the posed first person muzzle is from GetMuzzleLocation every frame. See Blackout.Muzzle.Report."),
+	ECVF_Default);
+
+/** What Blackout.Muzzle.Validate has measured for one gun */
+struct FMuzzleSamples
+{
+	int32 Count = 0;
+	FVector OffsetSum = FVector::ZeroVector;
+	float MaxError = 0.f;
+	float AllowedError = 0.f;
+};
+
+static TMap<FName, FMuzzleSamples> GMuzzleSamples;
+
+/**
+ * Logs the measured offset of each gun as a MuzzleOffsets line for DefaultGame.ini, keeping the MaxError it was
+ * played with, and flags any gun whose animated muzzle strayed further than that from the offset in use.
+ */
+static void ReportMuzzleSamples()
+{
+	for (const TPair<FName, FMuzzleSamples>& pair : GMuzzleSamples) {
+		const FMuzzleSamples& samples = pair.Value;
+		const FVector mean = samples.OffsetSum / FMath::Max(samples.Count, 1);
+		UE_LOG(LogBlackout, Display, TEXT("%s: %d frames, max error %.2f of %.2f allowed%s"), *pair.Key.ToString(), samples.Count,
+			samples.MaxError, samples.AllowedError, samples.MaxError > samples.AllowedError ? TEXT("  FAILED") : TEXT(""));
+		// The allowed error is a design tolerance, set by hand in the entry, never derived from what was measured
+		UE_LOG(LogBlackout, Display, TEXT("  +MuzzleOffsets=(Weapon=\"%s\",Offset=(X=%.2f,Y=%.2f,Z=%.2f),MaxError=%.1f)"),
+			*pair.Key.ToString(), mean.X, mean.Y, mean.Z, samples.AllowedError);
+	}
+}
+
+/**
+ * Blackout.Muzzle.Report
+ * Play on a client with Blackout.Muzzle.Validate on, run, jump and fire for a while, then run this. Also runs by
+ * itself when a game that measured anything exits, see Scripts/MuzzleOffsets.sh.
+ */
+static FAutoConsoleCommand MuzzleReportCommand(
+	TEXT("Blackout.Muzzle.Report"),
+	TEXT("Logs the measured muzzle offset and worst error of each gun"),
+	FConsoleCommandDelegate::CreateStatic(&ReportMuzzleSamples));
+
+/** Name MuzzleOffsets knows a gun by */
+static FName GetWeaponName(const USkeletalMeshComponent* gun)
+{
+	return gun && gun->SkeletalMesh ? gun->SkeletalMesh->GetFName() : NAME_None;
+}
+
+void ABlackoutCharacter::UpdateMuzzleOffset()
+{
+	const FName weapon = GetWeaponName(FP_Gun);
+	if (const FBlackoutMuzzleOffset* entry = MuzzleOffsets.FindByPredicate([weapon](const FBlackoutMuzzleOffset& e) { return e.Weapon == weapon; })) {
+		muzzleOffset = entry->Offset;
+		muzzleMaxError = entry->MaxError;
+		hasMeasuredMuzzle = true;
+		return;
+	}
+	hasMeasuredMuzzle = false;
+
+	static TSet<FName> warned;
+	if (HasAuthority() && !warned.Contains(weapon)) {
+		warned.Add(weapon);
+		UE_LOG(LogBlackout, Warning, TEXT("No MuzzleOffsets entry for %s, the server poses it to find the muzzle. Measure it with Scripts/MuzzleOffsets.sh."),
+			*weapon.ToString());
+	}
+
+	// Chain the attachments by hand: muzzle on the gun, gun snapped to the arms' GripPoint, arms on the camera
+	FTransform grip = FTransform::Identity;
+	const USkeletalMesh* arms = Mesh1P->SkeletalMesh;
+	const USkeletalMeshSocket* socket = arms ? arms->FindSocket(TEXT("GripPoint")) : nullptr;
+	const int32 bone = socket ? arms->RefSkeleton.FindBoneIndex(socket->BoneName) : INDEX_NONE;
+	if (bone != INDEX_NONE) {
+		grip = socket->GetSocketLocalTransform() * FAnimationRuntime::GetComponentSpaceTransformRefPose(arms->RefSkeleton, bone);
+	}
+	muzzleOffset = (FP_MuzzleLocation->GetRelativeTransform() * grip * Mesh1P->GetRelativeTransform()).GetLocation();
+}
+
+FVector ABlackoutCharacter::GetMuzzleLocation() const
+{
+	if (!hasMeasuredMuzzle && FP_MuzzleLocation->IsRegistered()) {
+		return FP_MuzzleLocation->GetComponentLocation();
+	}
+
+	// The camera is attached to the capsule and turns with the control rotation
+	const FVector cameraLocation = GetActorTransform().TransformPosition(FirstPersonCameraComponent->GetRelativeLocation());
+	return cameraLocation + GetControlRotation().RotateVector(muzzleOffset);
+}
+
+void ABlackoutCharacter::ValidateMuzzleLocation()
+{
+	if (!FP_MuzzleLocation->IsRegistered()) {
+		return;
+	}
+	// Against the camera's own transform, which only catches up with the control rotation when the view updates
+	const FTransform& camera = FirstPersonCameraComponent->GetComponentTransform();
+	const FVector posed = FP_MuzzleLocation->GetComponentLocation();
+
+	if (GMuzzleSamples.Num() == 0) {
+		FCoreDelegates::OnPreExit.AddStatic(&ReportMuzzleSamples);
+	}
+	FMuzzleSamples& samples = GMuzzleSamples.FindOrAdd(GetWeaponName(FP_Gun));
+	samples.Count++;
+	samples.OffsetSum += camera.InverseTransformPosition(posed);
+	samples.MaxError = FMath::Max(samples.MaxError, FVector::Dist(posed, camera.TransformPosition(muzzleOffset)));
+	samples.AllowedError = muzzleMaxError;
+}
+
+void ABlackoutCharacter::DoFire_Implementation(uint16 traceId)
+{
+	FBlackoutFireTrace::Get().Record(this, traceId, EBlackoutFireStage::ServerReceived);
+
+	if (GetAmmo() <= 0) {
+		return;
+	}
+	ABlackoutPlayerController* playerController = Cast<ABlackoutPlayerController>(GetController());
+	if (playerController && !playerController->ConsumeFireToken(fireRate)) {
+		return;
+	}
+
 	UWorld* const World = GetWorld();
 	if (World != NULL)
 	{
 		const FRotator SpawnRotation = GetControlRotation();
-		// MuzzleOffset is in camera space, so transform it to world space before offsetting from the character location to find the final muzzle position
-		const FVector SpawnLocation = ((FP_MuzzleLocation != nullptr) ? FP_MuzzleLocation->GetComponentLocation() : GetActorLocation()) + SpawnRotation.RotateVector(GunOffset);
+		// GunOffset is in camera space, so transform it to world space before offsetting from the muzzle to find the final spawn position
+		const FVector SpawnLocation = GetMuzzleLocation() + SpawnRotation.RotateVector(GunOffset);
 
 		//Set Spawn Collision Handling Override
 		FActorSpawnParameters ActorSpawnParams;
@@ -233,34 +625,56 @@ void ABlackoutCharacter::DoFire_Implementation()
 		ActorSpawnParams.Owner = this;
 
 		// spawn the projectile at the muzzle
+		BLACKOUT_LLM_SCOPE(Projectiles);
 		ABlackoutProjectile* projectile = World->SpawnActor<ABlackoutProjectile>(ProjectileClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
+		if (projectile == nullptr) {
+			// Spawn was blocked by collision
+			return;
+		}
+		projectile->ArenaIndex = ArenaIndex;
+		projectile->FireTraceId = traceId;
+		if (ABlackoutPlayerState* playerState = GetPlayerState<ABlackoutPlayerState>()) {
+			playerState->ShotsFired++;
+		}
+		FBlackoutFireTrace::Get().Record(this, traceId, EBlackoutFireStage::ServerSpawned);
 
-		if (GetAmmo() == 1) {
+		ABlackoutServerGovernor* governor = ABlackoutServerGovernor::Get(this);
+		const EBlackoutServerTier serverTier = governor ? governor->GetCurrentTier() : EBlackoutServerTier::Full;
+		if (GetAmmo() == 1 && serverTier < EBlackoutServerTier::Reduced) {
 			// Last shot
 			projectile->SetLightColor(LastShotColor);
 		}
+		if (serverTier >= EBlackoutServerTier::Minimal) {
+			projectile->NetUpdateFrequency = governor->MinimalProjectileNetUpdateFrequency;
+		}
 
 		// Decrease the players ammo by one
 		SetAmmo(GetAmmo() - 1);
 
 		// Call DoFireAnimation on all clients to play the sound and what-not
-		DoFireAnimation();
+		if (serverTier < EBlackoutServerTier::Minimal) {
+			DoFireAnimation(traceId);
+		}
 	}
 }
 
-void ABlackoutCharacter::DoFireAnimation_Implementation() {
+void ABlackoutCharacter::DoFireAnimation_Implementation(uint16 traceId) {
 	// Called on all clients
+	if (IsLocallyControlled()) {
+		FBlackoutFireTrace::Get().Record(this, traceId, EBlackoutFireStage::ClientFireSound);
+	}
 
 	// try and play the sound if specified
 	if (FireSound != NULL)
 	{
-		UGameplayStatics::PlaySoundAtLocation(this, FireSound, GetActorLocation());
+		ABlackoutSplitscreen::PlaySoundAtLocation(this, FireSound, GetActorLocation());
 	}
 }
 
 
 void ABlackoutCharacter::MoveForward(float Value)
 {
+	FBlackoutInputRecorder::Get().RecordAxis(this, EBlackoutInputAxis::MoveForward, Value);
 	if (Value != 0.0f)
 	{
 		// add movement in that direction
@@ -270,6 +684,7 @@ void ABlackoutCharacter::MoveForward(float Value)
 
 void ABlackoutCharacter::MoveRight(float Value)
 {
+	FBlackoutInputRecorder::Get().RecordAxis(this, EBlackoutInputAxis::MoveRight, Value);
 	if (Value != 0.0f)
 	{
 		// add movement in that direction
@@ -279,6 +694,7 @@ void ABlackoutCharacter::MoveRight(float Value)
 
 void ABlackoutCharacter::TurnAtRate(float Rate)
 {
+	FBlackoutInputRecorder::Get().RecordAxis(this, EBlackoutInputAxis::TurnRate, Rate);
 	if (paused) {
 		return;
 	}
@@ -289,6 +705,7 @@ void ABlackoutCharacter::TurnAtRate(float Rate)
 
 void ABlackoutCharacter::LookUpAtRate(float Rate)
 {
+	FBlackoutInputRecorder::Get().RecordAxis(this, EBlackoutInputAxis::LookUpRate, Rate);
 	if (paused) {
 		return;
 	}
@@ -299,6 +716,7 @@ void ABlackoutCharacter::LookUpAtRate(float Rate)
 
 void ABlackoutCharacter::Turn(float val)
 {
+	FBlackoutInputRecorder::Get().RecordAxis(this, EBlackoutInputAxis::Turn, val);
 	if (paused) {
 		return;
 	}
@@ -308,6 +726,7 @@ void ABlackoutCharacter::Turn(float val)
 
 void ABlackoutCharacter::LookUp(float val)
 {
+	FBlackoutInputRecorder::Get().RecordAxis(this, EBlackoutInputAxis::LookUp, val);
 	if (paused) {
 		return;
 	}
@@ -321,6 +740,9 @@ float ABlackoutCharacter::TakeDamage(float DamageTaken, struct FDamageEvent cons
 	if (GetController() != EventInstigator) {
 		// Decrement and apply health
 		int damageApplied = CurrentHealth - DamageTaken;
+		lastDamageInstigator = EventInstigator;
+		const ABlackoutProjectile* projectile = Cast<ABlackoutProjectile>(DamageCauser);
+		lastDamageTraceId = projectile ? projectile->FireTraceId : 0;
 		SetCurrentHealth(damageApplied);
 		return damageApplied;
 	}
@@ -328,11 +750,20 @@ float ABlackoutCharacter::TakeDamage(float DamageTaken, struct FDamageEvent cons
 }
 
 // Called on the server when the character dies
-void ABlackoutCharacter::Die_Implementation() {
+void ABlackoutCharacter::Die() {
+	AController* killer = lastDamageInstigator.Get();
+	// By player state, the killer may have died since firing and have no pawn
+	const APlayerState* killerState = killer ? killer->PlayerState : nullptr;
+	const uint16 traceId = killerState ? lastDamageTraceId : 0;
+	FBlackoutFireTrace::Get().Record(killerState, traceId, EBlackoutFireStage::ServerKill);
+
+	// Before respawning, so the death sound plays where we died
+	DieAnimation(killerState, traceId);
 
 	// Game mode is respawnable for handling respawning, get it.
 	ABlackoutGameMode* gameMode = dynamic_cast<ABlackoutGameMode*>(GetWorld()->GetAuthGameMode());
 	if (gameMode) {
+		gameMode->ScoreKill(killer, GetController());
 		gameMode->RespawnPlayer(this);
 	}
 	else {
@@ -340,19 +771,15 @@ void ABlackoutCharacter::Die_Implementation() {
 		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, TEXT("!!!ABlackoutCharacter must be used with ABlackoutGameMode or subclass. Tell Fred if you ever see this message."));
 	}
 
-	// For legacy reasons, we need to get the play controller, I wounder if this will change
-	APlayerController* playerController = dynamic_cast<APlayerController*>(GetController());
-	if (playerController) {
-		DieAnimation(playerController->GetPlayerNetworkAddress());
-	}
-	else {
-		// This shouldn't happen. Did someone try to implement AI?
-		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, TEXT("!!!Tried to kill a non-player pawn. Tell Fred if you ever see this message."));
-	}
-	
+	lastDamageInstigator = nullptr;
+	lastDamageTraceId = 0;
 }
 
-void ABlackoutCharacter::DieAnimation_Implementation(const FString& name) {
+void ABlackoutCharacter::DieAnimation_Implementation(const APlayerState* killerState, uint16 traceId) {
+	if (GetNetMode() == NM_Client) {
+		FBlackoutFireTrace::Get().Record(killerState, traceId, EBlackoutFireStage::ClientKill);
+	}
+
 	// Only display the death message on the controlling player's computer
 	if (IsLocallyControlled())
 	{
@@ -370,31 +797,68 @@ void ABlackoutCharacter::DieAnimation_Implementation(const FString& name) {
 		}
 	}
 
-	// Display death message
-	FString deathMessage = FString::Printf(TEXT("%s has been blacked out."), *name);
-	GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, deathMessage);
-
 	if(DeathSound != NULL)
-		UGameplayStatics::PlaySoundAtLocation(this, DeathSound, GetActorLocation());
+		ABlackoutSplitscreen::PlaySoundAtLocation(this, DeathSound, GetActorLocation());
 }
 
+static TAutoConsoleVariable<int32> CVarAutopilot(
+	TEXT("Blackout.Autopilot"),
+	0,
+	TEXT("Drive locally controlled characters with scripted input: run, strafe, turn and fire whenever possible. Used by the network tests."),
+	ECVF_Default);
+
 void ABlackoutCharacter::Tick(float deltaTime) {
 	Super::Tick(deltaTime);
-	timeSinceLastShot += deltaTime;
+
+	if (CVarAutopilot.GetValueOnGameThread() != 0 && IsLocallyControlled()) {
+		TickAutopilot(deltaTime);
+	}
+	if (CVarMuzzleValidate.GetValueOnGameThread() != 0 && IsLocallyControlled()) {
+		ValidateMuzzleLocation();
+	}
+}
+
+void ABlackoutCharacter::TickAutopilot(float deltaTime)
+{
+	// Goes through the same handlers as the input bindings, so everything downstream is the real thing.
+	// Load clients start at different points of the pattern, or they would all walk and turn in lockstep. The offset
+	// is seeded so runs repeat: from the gameplay seed where there is a game mode, from the server assigned player
+	// id on clients, which is the same every run with the same join order.
+	if (autopilotTime == 0.f && FBlackoutLoadGenerator::IsHeadless()) {
+		const ABlackoutGameMode* gameMode = GetWorld()->GetAuthGameMode<ABlackoutGameMode>();
+		const APlayerState* playerState = GetPlayerState();
+		if (gameMode) {
+			autopilotTime = gameMode->GetGameplayRandom().FRandRange(0.f, 60.f);
+		}
+		else if (playerState) {
+			autopilotTime = FRandomStream(playerState->PlayerId).FRandRange(0.f, 60.f);
+		}
+		else {
+			return;
+		}
+	}
+	autopilotTime += deltaTime;
+	MoveForward(1.f);
+	MoveRight(FMath::Sin(autopilotTime * 1.3f));
+	Turn(FMath::Sin(autopilotTime * 0.4f) * 2.f);
+	OnFire();
 }
 
 void ABlackoutCharacter::Jump()
 {
+	// Presses in the air or mid jump do nothing, don't spend the server's jump budget on them
+	const bool canJump = CanJump();
 	Super::Jump();
-	ServerJump();
+	if (canJump) {
+		ServerJump();
+	}
 }
 
 void ABlackoutCharacter::OnFootstep() {
 	// Called at regular intervals to play footsteps.
-
 	if (GetVelocity().Size() > footStepMinVelocity && GetCharacterMovement()->IsWalking()) {
 		if (FootStep != NULL) {
-			UGameplayStatics::PlaySoundAtLocation(this, FootStep, GetActorLocation());
+			ABlackoutSplitscreen::PlaySoundAtLocation(this, FootStep, GetActorLocation());
 		}
 	}
 }
@@ -409,15 +873,27 @@ void ABlackoutCharacter::OnRep_Ammo()
 	OnAmmoUpdate();
 }
 
+bool ABlackoutCharacter::ServerJump_Validate()
+{
+	const ABlackoutPlayerController* playerController = Cast<ABlackoutPlayerController>(GetController());
+	return !playerController || !playerController->IsFloodingRpcs();
+}
+
 void ABlackoutCharacter::ServerJump_Implementation()
 {
-	DoJumpAnimation();
+	ABlackoutPlayerController* playerController = Cast<ABlackoutPlayerController>(GetController());
+	if (playerController && !playerController->ConsumeJumpToken()) {
+		return;
+	}
+	if (ABlackoutServerGovernor::GetTier(this) < EBlackoutServerTier::Reduced) {
+		DoJumpAnimation();
+	}
 }
 
 void ABlackoutCharacter::DoJumpAnimation_Implementation()
 {
 	if (JumpSound != NULL) {
-		UGameplayStatics::PlaySoundAtLocation(this, JumpSound, GetActorLocation());
+		ABlackoutSplitscreen::PlaySoundAtLocation(this, JumpSound, GetActorLocation());
 	}
 }
 
@@ -427,17 +903,13 @@ void ABlackoutCharacter::OnHealthUpdate()
 	if (IsLocallyControlled())
 	{
 		// Update the lighting
-		if (CurrentHealth > NotifyAtHealth) {
-			PersonalLight->SetLightColor(FullHeathColor);
-		}
-		else {
-			PersonalLight->SetLightColor(LowHealthColor);
-		}
-
-		// Die if you should
-		if (CurrentHealth <= 0)
-		{
-			Die();
+		if (PersonalLight) {
+			if (CurrentHealth > NotifyAtHealth) {
+				PersonalLight->SetLightColor(FullHeathColor);
+			}
+			else {
+				PersonalLight->SetLightColor(LowHealthColor);
+			}
 		}
 	}
 }
@@ -450,6 +922,11 @@ void ABlackoutCharacter::SetCurrentHealth(int healthValue)
 			CurrentHealth = healthValue;
 		}
 		OnHealthUpdate();
+
+		// Resolved right here, without waiting for the victim's client to notice
+		if (CurrentHealth <= 0) {
+			Die();
+		}
 	}
 }
 
@@ -460,7 +937,7 @@ void ABlackoutCharacter::SetAmmo(int ammoValue)
 		if (0 <= ammoValue && ammoValue <= ClipSize) {
 			Ammo = ammoValue;
 		}
-		if (Ammo <= 0) {
+		if (Ammo <= 0 && ABlackoutServerGovernor::GetTier(this) < EBlackoutServerTier::Reduced) {
 			OutOfAmmoAnimation();
 		}
 		OnAmmoUpdate();
@@ -472,6 +949,6 @@ void ABlackoutCharacter::OnAmmoUpdate() {}
 void ABlackoutCharacter::OutOfAmmoAnimation_Implementation() {
 	GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, "Out of Ammo");
 	if (OutOfAmmoSound != NULL) {
-		UGameplayStatics::PlaySoundAtLocation(this, OutOfAmmoSound, GetActorLocation());
+		ABlackoutSplitscreen::PlaySoundAtLocation(this, OutOfAmmoSound, GetActorLocation());
 	}
 }
\ No newline at end of file
@@ -6,9 +6,31 @@
 #include "GameFramework/Character.h"
 #include "GameFramework/Actor.h"
 #include "Components/PointLightComponent.h"
+#include "BlackoutScheduler.h"
 #include "BlackoutCharacter.generated.h"
 
 class UInputComponent;
+class UActorChannel;
+class APlayerState;
+
+/** Where one first person gun's muzzle is relative to the first person camera, see ABlackoutCharacter::GetMuzzleLocation */
+USTRUCT()
+struct FBlackoutMuzzleOffset
+{
+	GENERATED_BODY()
+
+	/** Name of the gun's skeletal mesh asset */
+	UPROPERTY(Config)
+	FName Weapon;
+
+	/** Muzzle location in camera space, averaged over the arm animations. Measure with Blackout.Muzzle.Validate. */
+	UPROPERTY(Config)
+	FVector Offset = FVector::ZeroVector;
+
+	/** Furthest the animated muzzle may stray from Offset before Blackout.Muzzle.Report fails */
+	UPROPERTY(Config)
+	float MaxError = 5.f;
+};
 
 UCLASS(config=Game)
 class ABlackoutCharacter : public ACharacter
@@ -36,7 +58,7 @@ class ABlackoutCharacter : public ACharacter
 	class UPointLightComponent* PersonalLight;
 
 public:
-	ABlackoutCharacter();
+	ABlackoutCharacter(const FObjectInitializer& ObjectInitializer);
 
 protected:
 	/** Called when the game launches */
@@ -45,6 +67,16 @@ protected:
 	/** Called once every tick */
 	void Tick(float deltaTime) override;
 
+	void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	void PossessedBy(AController* NewController) override;
+	void PawnClientRestart() override;
+
+	/**
+	 * Registers the first person components (camera, arms, gun, muzzle and PersonalLight) only where they are used.
+	 * Simulated proxies never register them. The server only poses the gun while it has no MuzzleOffsets entry.
+	 */
+	void UpdateFirstPersonComponents();
+
 	void Jump() override;
 
 public:
@@ -81,6 +113,20 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void Pause();
 
+	/**
+	 * Where projectiles are spawned from, before GunOffset. For a gun with an entry in MuzzleOffsets it is derived
+	 * from the camera position and control rotation, so the server doesn't have to pose the first person meshes to
+	 * know it. Other guns are posed and use their muzzle component, as before.
+	 */
+	FVector GetMuzzleLocation() const;
+
+	/** Camera space muzzle position per gun, measured with Scripts/MuzzleOffsets.sh */
+	UPROPERTY(Config)
+	TArray<FBlackoutMuzzleOffset> MuzzleOffsets;
+
+	/** Calls the input handlers with one frame of recorded input, see FBlackoutInputRecorder */
+	void ReplayInput(const struct FBlackoutInputFrame& frame);
+
 protected:
 	
 	/** Fires a projectile. */
@@ -119,9 +165,27 @@ public:
 	FORCEINLINE class USkeletalMeshComponent* GetMesh1P() const { return Mesh1P; }
 	/** Returns FirstPersonCameraComponent subobject **/
 	FORCEINLINE class UCameraComponent* GetFirstPersonCameraComponent() const { return FirstPersonCameraComponent; }
+	/** Returns PersonalLight subobject, null where it isn't used **/
+	FORCEINLINE class UPointLightComponent* GetPersonalLight() const { return PersonalLight; }
+
+	/** The components UpdateFirstPersonComponents registers only where they are used */
+	TArray<UActorComponent*, TInlineAllocator<5>> GetFirstPersonComponents() const;
 
 	void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
+	bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
+	bool IsReplayRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation, const float CullDistanceSquared) const override;
+	float GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth) override;
+
+	/**
+	 * True if a viewer could see this character right now: it is the viewer, it is lit by a projectile, or it is
+	 * close enough to be lit by the viewer's PersonalLight. Server only.
+	 */
+	bool IsRevealedTo(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const;
+
+	/** Arena this character is playing in, or INDEX_NONE outside of ABlackoutArenaGameMode. Server only. */
+	int32 ArenaIndex = INDEX_NONE;
+
 	/** Getter for Max Health.*/
 	UFUNCTION(BlueprintPure, Category = "Health")
 	FORCEINLINE int GetMaxHealth() const { return MaxHealth; }
@@ -138,7 +202,7 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Ammo")
 	FORCEINLINE int GetClipSize() const { return ClipSize; }
 
-	/** Setter for Current Health. Clamps the value between 0 and MaxHealth and calls OnHealthUpdate. Should only be called on the server.*/
+	/** Setter for Current Health. Clamps the value between 0 and MaxHealth and calls OnHealthUpdate, and Die once health reaches 0. Should only be called on the server.*/
 	UFUNCTION(BlueprintCallable, Category = "Health")
 	void SetCurrentHealth(int healthValue);
 
@@ -174,8 +238,7 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Health")
 	float TakeDamage(float DamageTaken, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
 
-	/** Called when the user should die. Only runs on the server. */
-	UFUNCTION(Server, Reliable)
+	/** Scores the kill and respawns the player. Called by SetCurrentHealth on the server as soon as health reaches 0. */
 	void Die();
 
 	/** The player's maximum health. This is the highest that their health can be, and the value that their health starts at when spawned.*/
@@ -213,8 +276,8 @@ public:
 	UFUNCTION(NetMulticast, Reliable)
 	void OutOfAmmoAnimation();
 
-	/** Called on the server when a player jumps */
-	UFUNCTION(Server, Reliable)
+	/** Called on the server when a player jumps. Rate limited per connection, floods disconnect the client. */
+	UFUNCTION(Server, Reliable, WithValidation)
 	void ServerJump();
 
 	/** Called on all clients when a player jumps */
@@ -222,14 +285,22 @@ public:
 	void DoJumpAnimation();
 
 protected:
-	UFUNCTION(Server, Reliable)
-	void DoFire();
+	/**
+	 * Fires on the server. `traceId` ties the shot to its FBlackoutFireTrace entry, 0 if not traced.
+	 * Ammo and the fire rate are enforced here, per connection, whatever the client thinks. Floods disconnect the client.
+	 */
+	UFUNCTION(Server, Reliable, WithValidation)
+	void DoFire(uint16 traceId);
 
+	/**
+	 * Plays the death sound, and shows game over to the dying player. The kill feed announces the death.
+	 * `killerState` and `traceId` identify the killing shot for FBlackoutFireTrace, null and 0 if it isn't traced.
+	 */
 	UFUNCTION(NetMulticast, Reliable)
-	void DieAnimation(const FString& name);
+	void DieAnimation(const APlayerState* killerState, uint16 traceId);
 
 	UFUNCTION(NetMulticast, Reliable)
-	void DoFireAnimation();
+	void DoFireAnimation(uint16 traceId);
 
 	/** Called when the amount of health changes */
 	void OnHealthUpdate();
@@ -238,14 +309,57 @@ protected:
 	void OnAmmoUpdate();
 
 private:
-	/** Records the amount of time, in seconds, since the user last shoot. Used for fire delay */
-	float timeSinceLastShot;
+	/** World time the user may shoot again. Used for fire delay */
+	float nextShotTime = 0.f;
 
 	/** True if the pause menu is shown, and the player shouldn't respond to inputs */
 	bool paused;
 
-	/** Used by unreal to call OnFootstep at regular intervals */
-	FTimerHandle footstepHandler;
+	/** Sets how the third person mesh animates for this machine and registers with the animation budget */
+	void ConfigureAnimationBudget();
+
+	/** Budget this character's animation is throttled by, if any */
+	TWeakObjectPtr<class ABlackoutAnimationBudget> animationBudget;
+
+	/** Whoever damaged us last gets the kill. Server only. */
+	TWeakObjectPtr<AController> lastDamageInstigator;
+
+	/** FBlackoutFireTrace id of the projectile that damaged us last, 0 if not traced */
+	uint16 lastDamageTraceId = 0;
+
+	/** Finds this character's gun in MuzzleOffsets, or works the offset out from the reference pose for validating one */
+	void UpdateMuzzleOffset();
+
+	/** Compares GetMuzzleLocation with the posed muzzle while Blackout.Muzzle.Validate is on */
+	void ValidateMuzzleLocation();
+
+	/** Camera space muzzle position of the current gun */
+	FVector muzzleOffset = FVector::ZeroVector;
+	float muzzleMaxError = 5.f;
+
+	/** True if muzzleOffset comes from MuzzleOffsets and GetMuzzleLocation can use it */
+	bool hasMeasuredMuzzle = false;
+
+	/** Bound to the Jump and Pause actions, so input can be recorded apart from other callers */
+	void OnJumpPressed();
+	void OnJumpReleased();
+	void OnPausePressed();
+
+	/** Feeds scripted input while Blackout.Autopilot is on */
+	void TickAutopilot(float deltaTime);
+
+	/** Seconds the autopilot has been driving */
+	float autopilotTime = 0.f;
+
+	/** Calls OnFootstep at regular intervals, on the world's ABlackoutScheduler */
+	FBlackoutTimerHandle footstepTimer;
+
+	/** Frame IsLitByProjectile was last computed on, the answer is the same for every connection */
+	mutable uint64 litFrame = 0;
+	mutable bool bLitByProjectile = false;
+
+	/** True if any projectile light reaches this character. Cached for the current frame. */
+	bool IsLitByProjectile() const;
 
 	/** Current amount of ammo the player has */
 	UPROPERTY(ReplicatedUsing = OnRep_Ammo)
@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutCharacterMovementComponent.h"
+#include "Blackout.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/Character.h"
+#include "HAL/IConsoleManager.h"
+
+int64 UBlackoutCharacterMovementComponent::ServerMovesProcessed = 0;
+int64 UBlackoutCharacterMovementComponent::ServerCorrectionsSent = 0;
+
+static FAutoConsoleCommand MovementReportCommand(
+	TEXT("Blackout.Movement.Report"),
+	TEXT("Server: logs how many client moves were simulated and how many corrections were sent"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		const int64 moves = UBlackoutCharacterMovementComponent::ServerMovesProcessed;
+		const int64 corrections = UBlackoutCharacterMovementComponent::ServerCorrectionsSent;
+		UE_LOG(LogBlackout, Display, TEXT("Movement: %lld client moves simulated, %lld corrections sent (%.3f%%)"),
+			moves, corrections, 100.0 * corrections / FMath::Max<int64>(1, moves));
+	}));
+
+static TAutoConsoleVariable<int32> CVarCompactMoves(
+	TEXT("Blackout.Movement.Compact"),
+	1,
+	TEXT("Client: quantize acceleration and cap the move send rate. 0 sends moves the engine's way, to compare upstream bytes, see Scripts/MoveBandwidthTest.sh."),
+	ECVF_Default);
+
+UBlackoutCharacterMovementComponent::UBlackoutCharacterMovementComponent()
+{
+	AccelerationQuantizationSteps = 16;
+	MaxMoveSendRate = 30.f;
+}
+
+FVector UBlackoutCharacterMovementComponent::ScaleInputAcceleration(const FVector& InputAcceleration) const
+{
+	if (AccelerationQuantizationSteps <= 0 || CVarCompactMoves.GetValueOnGameThread() == 0) {
+		return Super::ScaleInputAcceleration(InputAcceleration);
+	}
+	const FVector acceleration = Super::ScaleInputAcceleration(InputAcceleration).GetClampedToMaxSize(GetMaxAcceleration());
+
+	// Multiples of MaxAcceleration / steps are well within what FVector_NetQuantize10 sends exactly
+	const float step = GetMaxAcceleration() / AccelerationQuantizationSteps;
+	const FVector snapped(
+		FMath::RoundToFloat(acceleration.X / step) * step,
+		FMath::RoundToFloat(acceleration.Y / step) * step,
+		FMath::RoundToFloat(acceleration.Z / step) * step);
+	if (snapped.SizeSquared() <= FMath::Square(GetMaxAcceleration())) {
+		return snapped;
+	}
+
+	// Rounding a diagonal outwards can leave the circle. Rounding towards zero never does, and stays on the grid,
+	// where clamping the length afterwards would not.
+	return FVector(
+		FMath::TruncToFloat(acceleration.X / step) * step,
+		FMath::TruncToFloat(acceleration.Y / step) * step,
+		FMath::TruncToFloat(acceleration.Z / step) * step);
+}
+
+float UBlackoutCharacterMovementComponent::GetClientNetSendDeltaTime(const APlayerController* PC, const FNetworkPredictionData_Client_Character* ClientData, const FSavedMovePtr& NewMove) const
+{
+	const float deltaTime = Super::GetClientNetSendDeltaTime(PC, ClientData, NewMove);
+	return MaxMoveSendRate > 0.f && CVarCompactMoves.GetValueOnGameThread() != 0 ? FMath::Max(deltaTime, 1.f / MaxMoveSendRate) : deltaTime;
+}
+
+void UBlackoutCharacterMovementComponent::MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel)
+{
+	ServerMovesProcessed++;
+	Super::MoveAutonomous(ClientTimeStamp, DeltaTime, CompressedFlags, NewAccel);
+}
+
+bool UBlackoutCharacterMovementComponent::IsSimulatedProxy() const
+{
+	return CharacterOwner && CharacterOwner->Role == ROLE_SimulatedProxy;
+}
+
+void UBlackoutCharacterMovementComponent::SmoothCorrection(const FVector& OldLocation, const FQuat& OldRotation, const FVector& NewLocation, const FQuat& NewRotation)
+{
+	if (IsSimulatedProxy() && FBlackoutJitterBuffer::IsEnabled()) {
+		if (baseSmoothLocationTime <= 0.f) {
+			baseSmoothLocationTime = NetworkSimulatedSmoothLocationTime;
+			baseSmoothRotationTime = NetworkSimulatedSmoothRotationTime;
+		}
+		jitterBuffer.OnArrival(FPlatformTime::Seconds());
+
+		// Rotation keeps its ratio to location, the engine default is half
+		const float buffer = jitterBuffer.GetBufferSeconds();
+		NetworkSimulatedSmoothRotationTime = buffer * baseSmoothRotationTime / FMath::Max(baseSmoothLocationTime, KINDA_SMALL_NUMBER);
+		NetworkSimulatedSmoothLocationTime = buffer;
+	}
+	Super::SmoothCorrection(OldLocation, OldRotation, NewLocation, NewRotation);
+}
+
+void UBlackoutCharacterMovementComponent::SimulateMovement(float DeltaTime)
+{
+	// Once updates are overdue the guess only gets worse, and the further the proxy has run on the bigger the snap
+	// back when they resume
+	if (IsSimulatedProxy() && FBlackoutJitterBuffer::IsEnabled() && jitterBuffer.IsOverdue(FPlatformTime::Seconds())) {
+		Velocity = FVector::ZeroVector;
+		return;
+	}
+	Super::SimulateMovement(DeltaTime);
+}
+
+void UBlackoutCharacterMovementComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// The mesh is what gets smoothed, so it is what players see
+	if (IsSimulatedProxy() && CharacterOwner->GetMesh()) {
+		smoothness.Track(TEXT("Character"), CharacterOwner->GetMesh()->GetComponentLocation(), DeltaTime);
+	}
+}
+
+void UBlackoutCharacterMovementComponent::SendClientAdjustment()
+{
+	const FNetworkPredictionData_Server_Character* serverData = HasPredictionData_Server() ? GetPredictionData_Server_Character() : nullptr;
+	if (serverData && serverData->PendingAdjustment.TimeStamp > 0.f && !serverData->PendingAdjustment.bAckGoodMove) {
+		ServerCorrectionsSent++;
+	}
+	Super::SendClientAdjustment();
+}
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "BlackoutProxySmoothing.h"
+#include "BlackoutCharacterMovementComponent.generated.h"
+
+/**
+ * Character movement tuned for upstream bandwidth. Input acceleration is snapped to a coarse grid, so
+ * consecutive frames of the same input produce identical moves, which pass the engine's combine checks, and
+ * moves are sent at a capped rate instead of once per client frame.
+ *
+ * The quantized acceleration is what the client simulates with and exactly what the server receives, so
+ * client and server still agree and corrections are unchanged. `Blackout.Movement.Compact 0` turns both off on a
+ * client, Scripts/MoveBandwidthTest.sh compares upstream bytes per move with and without.
+ *
+ * On simulated proxies, corrections are smoothed over an adaptive jitter buffer (see FBlackoutJitterBuffer) and
+ * extrapolation stops once the next update is overdue.
+ */
+UCLASS()
+class BLACKOUT_API UBlackoutCharacterMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	UBlackoutCharacterMovementComponent();
+
+	void SmoothCorrection(const FVector& OldLocation, const FQuat& OldRotation, const FVector& NewLocation, const FQuat& NewRotation) override;
+	void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Steps per axis between zero and MaxAcceleration that input acceleration is snapped to. 0 disables. */
+	UPROPERTY(EditDefaultsOnly, Category = "Character Movement (Networking)")
+	int32 AccelerationQuantizationSteps;
+
+	/** Most move packets per second a client sends, whatever its frame rate. 0 leaves it to the GameNetworkManager. */
+	UPROPERTY(EditDefaultsOnly, Category = "Character Movement (Networking)")
+	float MaxMoveSendRate;
+
+	/** Moves the server has simulated and corrections it has sent, across every character. See Blackout.Movement.Report. */
+	static int64 ServerMovesProcessed;
+	static int64 ServerCorrectionsSent;
+
+protected:
+	FVector ScaleInputAcceleration(const FVector& InputAcceleration) const override;
+	float GetClientNetSendDeltaTime(const APlayerController* PC, const FNetworkPredictionData_Client_Character* ClientData, const FSavedMovePtr& NewMove) const override;
+	void MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel) override;
+	void SendClientAdjustment() override;
+	void SimulateMovement(float DeltaTime) override;
+
+private:
+	/** True if this is a remote character on a client */
+	bool IsSimulatedProxy() const;
+
+	FBlackoutJitterBuffer jitterBuffer;
+	FBlackoutSmoothnessTracker smoothness;
+
+	/** Engine smoothing times, scaled by the jitter buffer */
+	float baseSmoothLocationTime = 0.f;
+	float baseSmoothRotationTime = 0.f;
+};
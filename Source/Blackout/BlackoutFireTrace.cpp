@@ -0,0 +1,145 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutFireTrace.h"
+#include "Blackout.h"
+#include "BlackoutStats.h"
+#include "BlackoutMemory.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+static TAutoConsoleVariable<int32> CVarFireTrace(
+	TEXT("Blackout.FireTrace"),
+	0,
+	TEXT("Timestamp every shot through the fire path. See Blackout.FireTrace.Report."),
+	ECVF_Default);
+
+static FAutoConsoleCommand FireTraceReportCommand(
+	TEXT("Blackout.FireTrace.Report"),
+	TEXT("Logs fire latency percentiles per stage"),
+	FConsoleCommandDelegate::CreateLambda([]() { FBlackoutFireTrace::Get().Report(); }));
+
+static FAutoConsoleCommand FireTraceResetCommand(
+	TEXT("Blackout.FireTrace.Reset"),
+	TEXT("Forgets every traced shot"),
+	FConsoleCommandDelegate::CreateLambda([]() { FBlackoutFireTrace::Get().Reset(); }));
+
+static const TCHAR* GetStageName(EBlackoutFireStage stage)
+{
+	switch (stage) {
+	case EBlackoutFireStage::Input: return TEXT("Input");
+	case EBlackoutFireStage::ServerReceived: return TEXT("ServerReceived");
+	case EBlackoutFireStage::ServerSpawned: return TEXT("ServerSpawned");
+	case EBlackoutFireStage::ClientSpawned: return TEXT("ClientSpawned");
+	case EBlackoutFireStage::ClientFireSound: return TEXT("ClientFireSound");
+	case EBlackoutFireStage::ServerKill: return TEXT("ServerKill");
+	case EBlackoutFireStage::ClientKill: return TEXT("ClientKill");
+	default: return TEXT("Unknown");
+	}
+}
+
+FBlackoutFireTrace& FBlackoutFireTrace::Get()
+{
+	static FBlackoutFireTrace instance;
+	return instance;
+}
+
+bool FBlackoutFireTrace::IsEnabled()
+{
+	return CVarFireTrace.GetValueOnGameThread() != 0;
+}
+
+uint16 FBlackoutFireTrace::NewTraceId()
+{
+	if (!IsEnabled()) {
+		return 0;
+	}
+	if (++nextTraceId == 0) {
+		++nextTraceId;
+	}
+	return nextTraceId;
+}
+
+uint64 FBlackoutFireTrace::MakeKey(const AActor* shooter, uint16 traceId)
+{
+	const APawn* pawn = Cast<APawn>(shooter);
+	const APlayerState* playerState = pawn ? pawn->GetPlayerState() : Cast<APlayerState>(shooter);
+	const uint32 playerId = playerState ? (uint32)playerState->PlayerId : 0;
+	return ((uint64)playerId << 16) | traceId;
+}
+
+void FBlackoutFireTrace::Record(const AActor* shooter, uint16 traceId, EBlackoutFireStage stage)
+{
+	if (traceId == 0) {
+		return;
+	}
+
+	BLACKOUT_LLM_SCOPE(Telemetry);
+	const uint64 key = MakeKey(shooter, traceId);
+	FTrace* trace = Traces.Find(key);
+	if (!trace) {
+		if (Traces.Num() >= MaxTraces) {
+			return;
+		}
+		trace = &Traces.Add(key);
+		for (int32 i = 0; i < (int32)EBlackoutFireStage::Count; i++) {
+			trace->Seconds[i] = -1.0;
+			trace->Frames[i] = 0;
+		}
+	}
+
+	// Keep the first time a stage is reached, e.g. if a multicast is received twice
+	if (trace->Seconds[(int32)stage] < 0.0) {
+		trace->Seconds[(int32)stage] = FPlatformTime::Seconds();
+		trace->Frames[(int32)stage] = GFrameCounter;
+	}
+}
+
+void FBlackoutFireTrace::Report() const
+{
+	const int32 numStages = (int32)EBlackoutFireStage::Count;
+	TArray<float> milliseconds[numStages];
+	TArray<float> frames[numStages];
+	int32 incomplete = 0;
+
+	for (const TPair<uint64, FTrace>& pair : Traces) {
+		const FTrace& trace = pair.Value;
+
+		// Measure from the earliest stage this process saw
+		int32 first = 0;
+		while (first < numStages && trace.Seconds[first] < 0.0) {
+			first++;
+		}
+
+		bool complete = true;
+		for (int32 stage = first; stage < numStages; stage++) {
+			if (trace.Seconds[stage] < 0.0) {
+				// Most shots never kill, only the fire path itself has to be there
+				complete &= stage >= (int32)EBlackoutFireStage::ServerKill;
+				continue;
+			}
+			milliseconds[stage].Add((trace.Seconds[stage] - trace.Seconds[first]) * 1000.0);
+			frames[stage].Add(trace.Frames[stage] - trace.Frames[first]);
+		}
+		incomplete += complete ? 0 : 1;
+	}
+
+	UE_LOG(LogBlackout, Display, TEXT("Fire trace: %d shots, %d missing at least one later stage"), Traces.Num(), incomplete);
+	for (int32 stage = 0; stage < numStages; stage++) {
+		if (milliseconds[stage].Num() == 0) {
+			continue;
+		}
+		const int32 count = milliseconds[stage].Num();
+		const FString ms = BlackoutStats::FormatPercentiles(milliseconds[stage]);
+		const FString frameCounts = BlackoutStats::FormatPercentiles(frames[stage]);
+		UE_LOG(LogBlackout, Display, TEXT("  %-16s %5d shots  ms: %s  frames: %s"),
+			GetStageName((EBlackoutFireStage)stage), count, *ms, *frameCounts);
+	}
+}
+
+void FBlackoutFireTrace::Reset()
+{
+	Traces.Reset();
+}
@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+
+/** The points a shot passes through on its way from a click to a sound */
+enum class EBlackoutFireStage : uint8
+{
+	/** OnFire on the shooting client */
+	Input,
+	/** DoFire arrives on the server */
+	ServerReceived,
+	/** The projectile has been spawned on the server */
+	ServerSpawned,
+	/** The replicated projectile begins play on the shooting client */
+	ClientSpawned,
+	/** DoFireAnimation plays the fire sound on the shooting client */
+	ClientFireSound,
+	/** The shot's damage killed its target on the server. Only shots that kill get this far. */
+	ServerKill,
+	/** The victim's death reached a client, if the victim was relevant to it */
+	ClientKill,
+
+	Count
+};
+
+/**
+ * Timestamps every shot as it moves through the fire path, so input latency can be broken down by stage.
+ *
+ * Enable with `Blackout.FireTrace 1`, play, then run `Blackout.FireTrace.Report`. Every process reports the
+ * stages it saw: in PIE the server and clients share a clock so the full path is reported, on separate
+ * machines each side reports its own part. Combine with `Net PktLag=`, `Net PktLagVariance=` and `Net PktLoss=`
+ * to see how network conditions show up in each stage.
+ */
+class BLACKOUT_API FBlackoutFireTrace
+{
+public:
+	static FBlackoutFireTrace& Get();
+
+	/** True if `Blackout.FireTrace` is on */
+	static bool IsEnabled();
+
+	/** Returns a new trace id for a shot, or 0 if tracing is off. 0 is never a valid id. */
+	uint16 NewTraceId();
+
+	/** Records that a shot fired by `shooter`, a pawn or its player state, reached a stage. Does nothing for trace id 0. */
+	void Record(const AActor* shooter, uint16 traceId, EBlackoutFireStage stage);
+
+	/** Logs latency percentiles for every stage, relative to the first stage each shot was seen at */
+	void Report() const;
+
+	void Reset();
+
+private:
+	struct FTrace
+	{
+		double Seconds[(int32)EBlackoutFireStage::Count];
+		uint64 Frames[(int32)EBlackoutFireStage::Count];
+	};
+
+	/** Shots are keyed by the shooter's PlayerId and trace id, which agree on every machine */
+	static uint64 MakeKey(const AActor* shooter, uint16 traceId);
+
+	/** Upper bound on stored shots, so a forgotten trace cannot grow forever */
+	static const int32 MaxTraces = 65536;
+
+	TMap<uint64, FTrace> Traces;
+
+	uint16 nextTraceId = 0;
+};
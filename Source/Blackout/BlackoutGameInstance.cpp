@@ -0,0 +1,283 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutGameInstance.h"
+#include "Blackout.h"
+#include "BlackoutHitchDetector.h"
+#include "BlackoutInputRecorder.h"
+#include "BlackoutLoadGenerator.h"
+#include "BlackoutMetricsServer.h"
+#include "BlackoutProxySmoothing.h"
+#include "BlackoutGameMode.h"
+#include "BlackoutStats.h"
+#include "Engine/DemoNetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Misc/PackageName.h"
+#include "TimerManager.h"
+#include "UObject/UObjectGlobals.h"
+
+/** Blackout.Spectate <Name> [DelaySeconds] */
+static FAutoConsoleCommandWithWorldAndArgs SpectateCommand(
+	TEXT("Blackout.Spectate"),
+	TEXT("Watches a live spectator broadcast. Usage: Blackout.Spectate <Name> [DelaySeconds]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UBlackoutGameInstance* gameInstance = World ? Cast<UBlackoutGameInstance>(World->GetGameInstance()) : nullptr;
+		if (!gameInstance || Args.Num() < 1) {
+			UE_LOG(LogBlackout, Warning, TEXT("Usage: Blackout.Spectate <Name> [DelaySeconds]"));
+			return;
+		}
+		const float delay = Args.Num() > 1 ? FCString::Atof(*Args[1]) : gameInstance->SpectatorDelaySeconds;
+		gameInstance->SpectateBroadcast(Args[0], delay);
+	}));
+
+/** Seconds before the first round of a -RoundTest, for clients to join */
+static const float RoundTestWarmupSeconds = 30.f;
+
+/** Seconds each round of a -RoundTest is played before the next reset or reload */
+static const float RoundTestIntervalSeconds = 5.f;
+
+/** Seconds between checks of whether a live broadcast has streamed in far enough to seek behind the match */
+static const float SpectatorSeekInterval = 0.5f;
+
+UBlackoutGameInstance::UBlackoutGameInstance()
+{
+	SpectatorReplayStreamer = TEXT("LocalFileNetworkReplayStreaming");
+	SpectatorDelaySeconds = 30.f;
+	PreloadedMap = nullptr;
+}
+
+void UBlackoutGameInstance::Init()
+{
+	Super::Init();
+	FBlackoutHitchDetector::Get().Start();
+	FBlackoutInputRecorder::Get().StartFromCommandLine();
+	FBlackoutMetricsServer::Get().StartFromCommandLine();
+	FBlackoutLoadGenerator::Get().StartFromCommandLine(this);
+	if (FParse::Value(FCommandLine::Get(), TEXT("RoundTest="), roundTestKind) && roundTestKind != TEXT("reset") && roundTestKind != TEXT("reload")) {
+		UE_LOG(LogBlackout, Error, TEXT("-RoundTest= takes reset or reload, not %s"), *roundTestKind);
+		roundTestKind.Empty();
+	}
+	FParse::Value(FCommandLine::Get(), TEXT("RoundTestRounds="), roundTestRounds);
+	postLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UBlackoutGameInstance::OnPostLoadMap);
+}
+
+void UBlackoutGameInstance::Shutdown()
+{
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(postLoadMapHandle);
+	FBlackoutHitchDetector::Get().Stop();
+	FBlackoutMetricsServer::Get().Stop();
+	FBlackoutLoadGenerator::Get().Stop();
+	FBlackoutInputRecorder::Get().StopRecording(GetWorld());
+	if (FBlackoutSmoothnessTracker::HasSamples()) {
+		FBlackoutSmoothnessTracker::LogReport();
+	}
+	Super::Shutdown();
+}
+
+void UBlackoutGameInstance::StartSpectatorBroadcast(const FString& name)
+{
+	TArray<FString> options;
+	options.Add(FString::Printf(TEXT("ReplayStreamerOverride=%s"), *SpectatorReplayStreamer));
+	StartRecordingReplay(name, name, options);
+	UE_LOG(LogBlackout, Log, TEXT("Broadcasting match to spectators as '%s' through %s"), *name, *SpectatorReplayStreamer);
+}
+
+void UBlackoutGameInstance::StopSpectatorBroadcast()
+{
+	StopRecordingReplay();
+}
+
+bool UBlackoutGameInstance::SpectateBroadcast(const FString& name, float delaySeconds)
+{
+	TArray<FString> options;
+	options.Add(FString::Printf(TEXT("ReplayStreamerOverride=%s"), *SpectatorReplayStreamer));
+	if (!PlayReplay(name, nullptr, options)) {
+		UE_LOG(LogBlackout, Warning, TEXT("Could not spectate '%s'"), *name);
+		return false;
+	}
+	pendingSpectatorDelay = FMath::Max(0.f, delaySeconds);
+	return true;
+}
+
+void UBlackoutGameInstance::OnPostLoadMap(UWorld* world)
+{
+	if (!world || world->GetGameInstance() != this) {
+		return;
+	}
+
+	// Arrived, the world itself keeps the map loaded from here on
+	if (world->GetOutermost()->GetFName() == preloadMapName) {
+		PreloadedMap = nullptr;
+		preloadMapName = NAME_None;
+	}
+
+	if (pendingSpectatorDelay < 0.f) {
+		return;
+	}
+	if (!world->DemoNetDriver) {
+		pendingSpectatorDelay = -1.f;
+		return;
+	}
+
+	// A live stream starts playing from the beginning, but only knows how long the match is once the stream's
+	// header and first checkpoint have arrived. Hold playback still and keep checking until then.
+	world->GetWorldSettings()->DemoPlayTimeDilation = 0.f;
+	world->GetTimerManager().SetTimer(spectatorSeekTimer, this, &UBlackoutGameInstance::SeekSpectatorDelay, SpectatorSeekInterval, true, 0.f);
+}
+
+void UBlackoutGameInstance::SeekSpectatorDelay()
+{
+	UWorld* world = GetWorld();
+	UDemoNetDriver* demo = world ? world->DemoNetDriver : nullptr;
+	if (!demo || pendingSpectatorDelay < 0.f) {
+		pendingSpectatorDelay = -1.f;
+		if (world) {
+			world->GetTimerManager().ClearTimer(spectatorSeekTimer);
+		}
+		return;
+	}
+
+	// Until the match is longer than the delay, any point in it would be less than the delay behind
+	const float total = demo->GetDemoTotalTime();
+	if (total <= 0.f || total < pendingSpectatorDelay) {
+		return;
+	}
+
+	world->GetTimerManager().ClearTimer(spectatorSeekTimer);
+	demo->GotoTimeInSeconds(total - pendingSpectatorDelay, FOnGotoTimeDelegate::CreateUObject(this, &UBlackoutGameInstance::OnSpectatorSeekDone));
+}
+
+void UBlackoutGameInstance::OnSpectatorSeekDone(bool success)
+{
+	UWorld* world = GetWorld();
+	if (!world || !world->DemoNetDriver) {
+		pendingSpectatorDelay = -1.f;
+		return;
+	}
+
+	// The checkpoint may not have reached the streamer yet, try again with a fresher total time
+	if (!success) {
+		world->GetTimerManager().SetTimer(spectatorSeekTimer, this, &UBlackoutGameInstance::SeekSpectatorDelay, SpectatorSeekInterval, true);
+		return;
+	}
+
+	world->GetWorldSettings()->DemoPlayTimeDilation = 1.f;
+	UE_LOG(LogBlackout, Log, TEXT("Spectating %.1f s behind the match"), pendingSpectatorDelay);
+	pendingSpectatorDelay = -1.f;
+}
+
+void UBlackoutGameInstance::BeginRoundTransition(const FString& kind)
+{
+	roundTransitionStart = FPlatformTime::Seconds();
+	roundTransitionKind = kind;
+}
+
+void UBlackoutGameInstance::EndRoundTransition()
+{
+	if (roundTransitionStart != 0) {
+		const double ms = (FPlatformTime::Seconds() - roundTransitionStart) * 1000.0;
+		UE_LOG(LogBlackout, Display, TEXT("Round turnaround (%s): %.1f ms"), *roundTransitionKind, ms);
+		if (roundTransitionKind == roundTestKind) {
+			roundTestMs.Add(ms);
+		}
+		roundTransitionStart = 0;
+	}
+	if (!roundTestKind.IsEmpty()) {
+		ContinueRoundTest();
+	}
+}
+
+void UBlackoutGameInstance::ContinueRoundTest()
+{
+	UWorld* world = GetWorld();
+	if (!world || !world->GetAuthGameMode<ABlackoutGameMode>()) {
+		return;
+	}
+	if (roundTestMs.Num() >= roundTestRounds) {
+		FinishRoundTest();
+		return;
+	}
+	// The first round gives clients time to join, later ones only need to settle
+	const float delay = roundTestMs.Num() == 0 ? RoundTestWarmupSeconds : RoundTestIntervalSeconds;
+	world->GetTimerManager().SetTimer(roundTestTimer, FTimerDelegate::CreateUObject(this, &UBlackoutGameInstance::StartTestRound), delay, false);
+}
+
+void UBlackoutGameInstance::StartTestRound()
+{
+	ABlackoutGameMode* gameMode = GetWorld() ? GetWorld()->GetAuthGameMode<ABlackoutGameMode>() : nullptr;
+	if (!gameMode) {
+		return;
+	}
+	if (roundTestKind == TEXT("reload")) {
+		gameMode->ReloadMatch();
+	}
+	else {
+		gameMode->ResetMatch();
+	}
+}
+
+void UBlackoutGameInstance::FinishRoundTest()
+{
+	roundTestMs.Sort();
+	const FString row = FString::Printf(TEXT("%s,%s,%d,%.1f,%.1f,%.1f\n"),
+		*UGameplayStatics::GetCurrentLevelName(GetWorld(), true), *roundTestKind, roundTestMs.Num(),
+		BlackoutStats::Percentile(roundTestMs, 50.f), BlackoutStats::Percentile(roundTestMs, 95.f),
+		BlackoutStats::Percentile(roundTestMs, 100.f));
+	UE_LOG(LogBlackout, Display, TEXT("Round test (%s): %d rounds, p50 %.1f / p95 %.1f / max %.1f ms"), *roundTestKind, roundTestMs.Num(),
+		BlackoutStats::Percentile(roundTestMs, 50.f), BlackoutStats::Percentile(roundTestMs, 95.f), BlackoutStats::Percentile(roundTestMs, 100.f));
+
+	const FString path = FPaths::Combine(FPaths::ProfilingDir(), TEXT("RoundTurnaround.csv"));
+	if (!FPaths::FileExists(path)) {
+		FFileHelper::SaveStringToFile(FString(TEXT("Map,Kind,Rounds,Ms.p50,Ms.p95,Ms.max\n")), *path);
+	}
+	FFileHelper::SaveStringToFile(row, *path, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+
+	roundTestKind.Empty();
+	FPlatformMisc::RequestExitWithStatus(false, 0);
+}
+
+void UBlackoutGameInstance::PreloadMap(const FString& mapPath)
+{
+	if (mapPath.IsEmpty()) {
+		return;
+	}
+	const FName packageName(*FPackageName::ObjectPathToPackageName(mapPath));
+	UWorld* world = GetWorld();
+	if (packageName == preloadMapName || (world && world->GetOutermost()->GetFName() == packageName)) {
+		return;
+	}
+	// Editor worlds are renamed per PIE instance and can't travel seamlessly anyway
+	if (world && world->IsPlayInEditor()) {
+		return;
+	}
+
+	PreloadedMap = nullptr;
+	preloadMapName = packageName;
+	preloadStart = FPlatformTime::Seconds();
+	LoadPackageAsync(packageName.ToString(), FLoadPackageAsyncDelegate::CreateUObject(this, &UBlackoutGameInstance::OnMapPreloaded));
+	UE_LOG(LogBlackout, Log, TEXT("Preloading %s"), *packageName.ToString());
+}
+
+void UBlackoutGameInstance::OnMapPreloaded(const FName& packageName, UPackage* package, EAsyncLoadingResult::Type result)
+{
+	if (packageName != preloadMapName) {
+		return;
+	}
+	if (result != EAsyncLoadingResult::Succeeded || !package) {
+		UE_LOG(LogBlackout, Warning, TEXT("Could not preload %s, travelling there will load it synchronously"), *packageName.ToString());
+		preloadMapName = NAME_None;
+		return;
+	}
+	PreloadedMap = package;
+	UE_LOG(LogBlackout, Log, TEXT("Preloaded %s in %.1f ms"), *packageName.ToString(), (FPlatformTime::Seconds() - preloadStart) * 1000.0);
+}
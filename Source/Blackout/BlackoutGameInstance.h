@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "Engine/GameInstance.h"
+#include "BlackoutGameInstance.generated.h"
+
+/**
+ * Game instance for Blackout. Owns everything that has to outlive a map, such as spectator broadcasts.
+ */
+UCLASS(config=Game)
+class BLACKOUT_API UBlackoutGameInstance : public UGameInstance
+{
+	GENERATED_BODY()
+
+public:
+	UBlackoutGameInstance();
+
+	void Init() override;
+	void Shutdown() override;
+
+	/**
+	 * Server: starts recording the match as a live replay stream. However many spectators watch it, the server only
+	 * ever replicates to this one recording, the replay streamer does the fan-out.
+	 */
+	void StartSpectatorBroadcast(const FString& name);
+
+	void StopSpectatorBroadcast();
+
+	/**
+	 * Client: starts watching a live broadcast, `delaySeconds` behind the match. Playback holds still until the
+	 * match has run for longer than the delay.
+	 */
+	bool SpectateBroadcast(const FString& name, float delaySeconds);
+
+	/**
+	 * Replay streamer module broadcasts go through. LocalFileNetworkReplayStreaming lets any number of spectator
+	 * processes on the same machine share the stream; HttpNetworkReplayStreaming pushes it to a relay server.
+	 */
+	UPROPERTY(Config)
+	FString SpectatorReplayStreamer;
+
+	/** Default spectator delay, so spectators cannot be used to scout */
+	UPROPERTY(Config)
+	float SpectatorDelaySeconds;
+
+	/**
+	 * Marks the end of a round. The time until EndRoundTransition is logged as the round turnaround.
+	 *
+	 * A server started with -RoundTest=reset or -RoundTest=reload (and -RoundTestRounds=N, 10 by default) starts a new
+	 * round that way every few seconds, appends the turnaround percentiles to Saved/Profiling/RoundTurnaround.csv
+	 * and exits. See Scripts/RoundResetTest.sh.
+	 */
+	void BeginRoundTransition(const FString& kind);
+
+	/** Marks the first frame of the next round, if a transition is in progress */
+	void EndRoundTransition();
+
+	/**
+	 * Starts loading a map package in the background and keeps it in memory, so seamless travel to it finds it
+	 * already loaded instead of loading it while players wait. Released once the map has been travelled to, or
+	 * when a different map is preloaded. Does nothing for an empty path or the current map.
+	 */
+	void PreloadMap(const FString& mapPath);
+
+private:
+	/** Pauses a freshly loaded live broadcast until it can be seeked back to the spectator delay */
+	void OnPostLoadMap(UWorld* world);
+
+	/** Seeks to the spectator delay once the broadcast is longer than it, retried on a timer until then */
+	void SeekSpectatorDelay();
+
+	/** Resumes playback once the seek lands, or goes back to waiting if it failed */
+	void OnSpectatorSeekDone(bool success);
+
+	void OnMapPreloaded(const FName& packageName, UPackage* package, EAsyncLoadingResult::Type result);
+
+	/** Next map, loaded ahead of travelling to it. Held here since the game instance outlives the current world. */
+	UPROPERTY()
+	UPackage* PreloadedMap;
+
+	/** Package name of the map being preloaded or held in PreloadedMap, None if there is none */
+	FName preloadMapName;
+
+	/** When the current preload started */
+	double preloadStart = 0;
+
+	FDelegateHandle postLoadMapHandle;
+
+	/** Delay to apply once the broadcast we are spectating has loaded, negative when not spectating */
+	float pendingSpectatorDelay = -1.f;
+
+	/** Retries SeekSpectatorDelay on the broadcast's world */
+	FTimerHandle spectatorSeekTimer;
+
+	/** When the current round transition started, 0 if there is none */
+	double roundTransitionStart = 0;
+
+	/** How the current round transition is happening, for the log */
+	FString roundTransitionKind;
+
+	/** Schedules the next round of a -RoundTest, or finishes it */
+	void ContinueRoundTest();
+
+	/** Resets or reloads the match for a -RoundTest */
+	void StartTestRound();
+
+	/** Logs and saves the -RoundTest results and exits */
+	void FinishRoundTest();
+
+	/** "reset" or "reload" during a -RoundTest, empty otherwise */
+	FString roundTestKind;
+
+	int32 roundTestRounds = 10;
+
+	/** Turnaround of each test round so far */
+	TArray<float> roundTestMs;
+
+	FTimerHandle roundTestTimer;
+};
@@ -6,6 +6,31 @@
 #include "UObject/ConstructorHelpers.h"
 #include "Kismet/GameplayStatics.h"
 #include "GameFramework/PlayerStart.h"
+#include "Engine/World.h"
+#include "Engine/DemoNetDriver.h"
+#include "BlackoutGameInstance.h"
+#include "BlackoutPlayerController.h"
+#include "BlackoutPlayerState.h"
+#include "BlackoutGameState.h"
+#include "BlackoutProjectile.h"
+#include "BlackoutServerGovernor.h"
+#include "BlackoutPerfTestController.h"
+#include "BlackoutHitchDetector.h"
+#include "BlackoutBeaconHostObject.h"
+#include "BlackoutInputRecorder.h"
+#include "BlackoutSplitscreen.h"
+#include "Blackout.h"
+#include "GameFramework/GameSession.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "TimerManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/PackageName.h"
+#include "Misc/Parse.h"
+#include "GameMapsSettings.h"
+#include "Engine/Engine.h"
+#include "Engine/NetConnection.h"
+#include "Powerup.h"
 
 ABlackoutGameMode::ABlackoutGameMode()
 	: Super()
@@ -16,15 +41,284 @@ ABlackoutGameMode::ABlackoutGameMode()
 
 	// use our custom HUD class
 	HUDClass = ABlackoutHUD::StaticClass();
+	PlayerControllerClass = ABlackoutPlayerController::StaticClass();
+	PlayerStateClass = ABlackoutPlayerState::StaticClass();
+	GameStateClass = ABlackoutGameState::StaticClass();
+
+	// Map rotation keeps everyone connected, see RotateMap
+	bUseSeamlessTravel = true;
+
+	LightExposureCellSize = 2500.f;
+	RevealRadius = 1000.f;
+	UnrevealedNetPriorityScale = 0.25f;
+}
+
+void ABlackoutGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+	LightExposure.Reset(LightExposureCellSize);
+	spectatorBroadcastName = UGameplayStatics::ParseOption(Options, TEXT("SpectatorBroadcast"));
+
+	int32 seed = 0;
+	if (!FBlackoutInputRecorder::Get().GetReplaySeed(seed)) {
+		seed = UGameplayStatics::HasOption(Options, TEXT("Seed")) ? UGameplayStatics::GetIntOption(Options, TEXT("Seed"), 0) : (int32)FPlatformTime::Cycles();
+	}
+	GameplayRandom.Initialize(seed);
+
+	// Headless load clients bring a lobby's worth of players over one connection, see FBlackoutLoadGenerator
+	if (FParse::Param(FCommandLine::Get(), TEXT("AllowLoadClients")) && GameSession) {
+		GameSession->MaxSplitscreensPerConnection = GameSession->MaxPlayers;
+	}
+	UE_LOG(LogBlackout, Log, TEXT("Gameplay seed %d"), seed);
+}
+
+AActor* ABlackoutGameMode::ChoosePlayerStart_Implementation(AController* Player)
+{
+	// Same as the engine's choice, unoccupied starts first, but drawn from the seeded stream
+	const APawn* pawnToFit = DefaultPawnClass ? DefaultPawnClass->GetDefaultObject<APawn>() : nullptr;
+	TArray<APlayerStart*> unoccupied;
+	TArray<APlayerStart*> occupied;
+	for (TActorIterator<APlayerStart> it(GetWorld()); it; ++it) {
+		if (pawnToFit && GetWorld()->EncroachingBlockingGeometry(pawnToFit, it->GetActorLocation(), it->GetActorRotation())) {
+			occupied.Add(*it);
+		}
+		else {
+			unoccupied.Add(*it);
+		}
+	}
+	const TArray<APlayerStart*>& starts = unoccupied.Num() > 0 ? unoccupied : occupied;
+	if (starts.Num() == 0) {
+		return Super::ChoosePlayerStart_Implementation(Player);
+	}
+	return starts[GameplayRandom.RandRange(0, starts.Num() - 1)];
+}
+
+void ABlackoutGameMode::StartPlay()
+{
+	Super::StartPlay();
+
+	// Seamless travel passes through the transition map on the way to the next match, nothing to start there
+	if (IsTransitionMap()) {
+		return;
+	}
+
+	// Listen servers and standalone games have a player to do the cosmetic work for
+	if (GetNetMode() == NM_DedicatedServer) {
+		Governor = GetWorld()->SpawnActor<ABlackoutServerGovernor>();
+	}
+	ABlackoutPerfTestController::StartIfRequested(GetWorld());
+	ABlackoutSplitscreen::StartIfRequested(GetWorld());
+
+	if (GetNetMode() == NM_DedicatedServer || GetNetMode() == NM_ListenServer) {
+		BeaconHostObject = ABlackoutBeaconHostObject::StartHost(GetWorld());
+	}
+
+	// The round starts with the first frame, which is where ResetMatch stops timing too
+	if (UBlackoutGameInstance* gameInstance = GetGameInstance<UBlackoutGameInstance>()) {
+		GetWorldTimerManager().SetTimerForNextTick(FTimerDelegate::CreateUObject(gameInstance, &UBlackoutGameInstance::EndRoundTransition));
+	}
+
+	// Load the next map while this match is played, clients start on it when NextMap replicates
+	const FString nextMap = GetNextMap();
+	if (ABlackoutGameState* gameState = GetGameState<ABlackoutGameState>()) {
+		gameState->NextMap = nextMap;
+	}
+	if (UBlackoutGameInstance* gameInstance = GetGameInstance<UBlackoutGameInstance>()) {
+		gameInstance->PreloadMap(nextMap);
+	}
+
+	if (!spectatorBroadcastName.IsEmpty()) {
+		if (UBlackoutGameInstance* gameInstance = GetGameInstance<UBlackoutGameInstance>()) {
+			gameInstance->StartSpectatorBroadcast(spectatorBroadcastName);
+		}
+		UDemoNetDriver* demo = GetWorld()->DemoNetDriver;
+		if (demo && demo->SpectatorController) {
+			OnSpectatorBroadcastStarted(demo->SpectatorController);
+		}
+	}
+}
+
+void ABlackoutGameMode::PreLogin(const FString& Options, const FString& Address, const FUniqueNetIdRepl& UniqueId, FString& ErrorMessage)
+{
+	Super::PreLogin(Options, Address, UniqueId, ErrorMessage);
+
+	// Slots held by beacon reservations are only for the players who made them
+	if (ErrorMessage.IsEmpty() && BeaconHostObject && !BeaconHostObject->AdmitPlayer(UGameplayStatics::ParseOption(Options, TEXT("Reservation")))) {
+		ErrorMessage = TEXT("Server full");
+	}
+}
+
+void ABlackoutGameMode::PostLogin(APlayerController* NewPlayer)
+{
+	Super::PostLogin(NewPlayer);
+
+	// The reservation holds the slot while the player loads the map, and is only given up once they have it
+	const UNetConnection* connection = NewPlayer ? NewPlayer->GetNetConnection() : nullptr;
+	if (BeaconHostObject && connection) {
+		const FURL url(nullptr, *connection->RequestURL, TRAVEL_Absolute);
+		BeaconHostObject->ConsumeReservation(url.GetOption(TEXT("Reservation="), TEXT("")));
+	}
+}
+
+int32 ABlackoutGameMode::GetMaxPlayers() const
+{
+	return GameSession ? GameSession->MaxPlayers : 0;
+}
+
+static FAutoConsoleCommandWithWorld ResetMatchCommand(
+	TEXT("Blackout.ResetMatch"),
+	TEXT("Server: starts a new round in place, without reloading the map"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (ABlackoutGameMode* gameMode = World ? World->GetAuthGameMode<ABlackoutGameMode>() : nullptr) {
+			gameMode->ResetMatch();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld NextMapCommand(
+	TEXT("Blackout.NextMap"),
+	TEXT("Server: ends the match and travels to the next map in the rotation"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (ABlackoutGameMode* gameMode = World ? World->GetAuthGameMode<ABlackoutGameMode>() : nullptr) {
+			gameMode->RotateMap();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld ReloadMatchCommand(
+	TEXT("Blackout.ReloadMatch"),
+	TEXT("Server: starts a new round by reloading the map, to compare against Blackout.ResetMatch"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (ABlackoutGameMode* gameMode = World ? World->GetAuthGameMode<ABlackoutGameMode>() : nullptr) {
+			gameMode->ReloadMatch();
+		}
+	}));
+
+void ABlackoutGameMode::ResetMatch()
+{
+	UBlackoutGameInstance* gameInstance = GetGameInstance<UBlackoutGameInstance>();
+	if (gameInstance) {
+		gameInstance->BeginRoundTransition(TEXT("reset"));
+	}
+
+	// Not ResetLevel, which resets every controller too: that unpossesses everyone and sends them to spectating.
+	// Characters keep their controllers and are respawned below instead.
+	for (TActorIterator<APowerup> it(GetWorld()); it; ++it) {
+		it->Reset();
+	}
+	TArray<ABlackoutProjectile*> projectiles;
+	for (TActorIterator<ABlackoutProjectile> it(GetWorld()); it; ++it) {
+		projectiles.Add(*it);
+	}
+	for (ABlackoutProjectile* projectile : projectiles) {
+		projectile->Destroy();
+	}
+
+	for (TActorIterator<ABlackoutCharacter> it(GetWorld()); it; ++it) {
+		RespawnPlayer(*it);
+	}
+	for (FConstPlayerControllerIterator it = GetWorld()->GetPlayerControllerIterator(); it; ++it) {
+		if (ABlackoutPlayerController* playerController = Cast<ABlackoutPlayerController>(it->Get())) {
+			playerController->ClientResetMatch();
+		}
+	}
+
+	// Timed to the first frame of the new round, as a reload is, see StartPlay
+	if (gameInstance) {
+		GetWorldTimerManager().SetTimerForNextTick(FTimerDelegate::CreateUObject(gameInstance, &UBlackoutGameInstance::EndRoundTransition));
+	}
+}
+
+void ABlackoutGameMode::ReloadMatch()
+{
+	if (UBlackoutGameInstance* gameInstance = GetGameInstance<UBlackoutGameInstance>()) {
+		gameInstance->BeginRoundTransition(TEXT("reload"));
+	}
+	GetWorld()->ServerTravel(TEXT("?Restart"), false);
+}
+
+bool ABlackoutGameMode::IsTransitionMap() const
+{
+	UWorld* world = GetWorld();
+	return GEngine && GEngine->SeamlessTravelHandlerForWorld(world).IsInTransition()
+		&& world->GetOutermost()->GetName() == UGameMapsSettings::GetGameMapsSettings()->TransitionMap.GetLongPackageName();
+}
+
+FString ABlackoutGameMode::GetNextMap() const
+{
+	const FString currentMap = GetWorld()->GetOutermost()->GetName();
+	const int32 index = MapRotation.IndexOfByPredicate([&currentMap](const FString& map) {
+		return FPackageName::ObjectPathToPackageName(map) == currentMap;
+	});
+	return index == INDEX_NONE ? FString() : MapRotation[(index + 1) % MapRotation.Num()];
+}
+
+void ABlackoutGameMode::RotateMap()
+{
+	const FString nextMap = GetNextMap();
+	if (nextMap.IsEmpty()) {
+		UE_LOG(LogBlackout, Warning, TEXT("%s is not in the map rotation"), *GetWorld()->GetMapName());
+		return;
+	}
+	if (UBlackoutGameInstance* gameInstance = GetGameInstance<UBlackoutGameInstance>()) {
+		gameInstance->BeginRoundTransition(TEXT("rotation"));
+	}
+	GetWorld()->ServerTravel(nextMap, false);
+}
+
+FBlackoutLightExposureGrid* ABlackoutGameMode::GetLightExposure(const UObject* worldContext)
+{
+	UWorld* world = worldContext ? worldContext->GetWorld() : nullptr;
+	ABlackoutGameMode* gameMode = world ? world->GetAuthGameMode<ABlackoutGameMode>() : nullptr;
+	return gameMode ? &gameMode->LightExposure : nullptr;
 }
 
 void ABlackoutGameMode::RespawnPlayer(ABlackoutCharacter* pawn) {
+	FBlackoutHitchDetector::Get().Mark(TEXT("Respawn"));
 	pawn->SetCurrentHealth(pawn->MaxHealth);
-	TArray<AActor*> spawn_points;
-	UGameplayStatics::GetAllActorsOfClass(this, APlayerStart::StaticClass(), spawn_points);
-	int spawn_index = FMath::RandRange(0, spawn_points.Num() - 1);	// Who makes a random number generate right inclusive?
-	AActor* spawn = spawn_points[spawn_index];
 
-	pawn->SetActorLocation(spawn->GetActorLocation());
+	AActor* spawn = ChooseRespawnPoint(pawn);
+	if (spawn) {
+		pawn->SetActorLocation(spawn->GetActorLocation());
+	}
 	pawn->SetAmmo(pawn->ClipSize);
-}
\ No newline at end of file
+}
+
+void ABlackoutGameMode::ScoreKill(AController* killer, AController* victim) {
+	ABlackoutPlayerState* victimState = victim ? Cast<ABlackoutPlayerState>(victim->PlayerState) : nullptr;
+	ABlackoutPlayerState* killerState = killer && killer != victim ? Cast<ABlackoutPlayerState>(killer->PlayerState) : nullptr;
+	if (victimState) {
+		victimState->Deaths++;
+	}
+	if (killerState) {
+		killerState->Kills++;
+	}
+
+	AnnounceKill(victim, killerState ? killerState->GetPlayerName() : FString(), victimState ? victimState->GetPlayerName() : FString());
+}
+
+void ABlackoutGameMode::AnnounceKill(AController* victim, const FString& killerName, const FString& victimName) {
+	if (ABlackoutGameState* gameState = GetGameState<ABlackoutGameState>()) {
+		gameState->KillFeed.AddKill(killerName, victimName);
+		gameState->ForceNetUpdate();
+	}
+
+	// Replication never reaches a listen server's own player
+	if (GetNetMode() != NM_DedicatedServer) {
+		FBlackoutKill kill;
+		kill.KillerName = killerName;
+		kill.VictimName = victimName;
+		kill.Show();
+	}
+}
+
+AActor* ABlackoutGameMode::ChooseRespawnPoint(ABlackoutCharacter* pawn) {
+	TArray<AActor*> spawn_points;
+	UGameplayStatics::GetAllActorsOfClass(this, APlayerStart::StaticClass(), spawn_points);
+	if (spawn_points.Num() == 0) {
+		return nullptr;
+	}
+	int spawn_index = GameplayRandom.RandRange(0, spawn_points.Num() - 1);	// Who makes a random number generate right inclusive?
+	return spawn_points[spawn_index];
+}
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
 #include "BlackoutCharacter.h"
+#include "BlackoutLightExposure.h"
 #include "BlackoutGameMode.generated.h"
 
 UCLASS(minimalapi)
@@ -14,7 +15,94 @@ class ABlackoutGameMode : public AGameModeBase
 
 public:
 	ABlackoutGameMode();
-	void RespawnPlayer(ABlackoutCharacter* pawn);
+	virtual void RespawnPlayer(ABlackoutCharacter* pawn);
+
+	/** Updates the scoreboard and kill feed for a death. `killer` is null if nobody gets the credit. */
+	void ScoreKill(AController* killer, AController* victim);
+
+	void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+	void StartPlay() override;
+	AActor* ChoosePlayerStart_Implementation(AController* Player) override;
+	void PreLogin(const FString& Options, const FString& Address, const FUniqueNetIdRepl& UniqueId, FString& ErrorMessage) override;
+	void PostLogin(APlayerController* NewPlayer) override;
+
+	/** Most players this server takes, as reported to beacon queries */
+	virtual int32 GetMaxPlayers() const;
+
+	/**
+	 * Starts a new round without reloading the map: every player respawns as in RespawnPlayer, powerups come back,
+	 * projectiles in flight are removed and HUDs are cleared.
+	 */
+	void ResetMatch();
+
+	/** Starts a new round the slow way, by reloading the current map. Kept for comparison with ResetMatch. */
+	void ReloadMatch();
+
+	/** Map after the current one in MapRotation, empty if the current map isn't in the rotation */
+	FString GetNextMap() const;
+
+	/**
+	 * Ends the match and seamlessly travels to the next map in MapRotation, through the transition map. The next map
+	 * has been preloading since the match started, and controllers and player states carry over.
+	 */
+	void RotateMap();
+
+	/** Maps matches rotate through, as object paths, see RotateMap */
+	UPROPERTY(Config)
+	TArray<FString> MapRotation;
+
+	/** Returns the light exposure grid of the world's game mode, or null when not on the server. */
+	static FBlackoutLightExposureGrid* GetLightExposure(const UObject* worldContext);
+
+	/**
+	 * Every random gameplay choice, such as spawn points, comes from this stream so a match can be reproduced.
+	 * Seeded from ?Seed= or the input recording being replayed, see FBlackoutInputRecorder, and random otherwise.
+	 */
+	FORCEINLINE const FRandomStream& GetGameplayRandom() const { return GameplayRandom; }
+
+	/** Frame time governor, null unless this is a dedicated server */
+	FORCEINLINE class ABlackoutServerGovernor* GetGovernor() const { return Governor; }
+
+	/** Size of a light exposure grid cell. Roughly the attenuation radius of a projectile light works best. */
+	UPROPERTY(Config, EditAnywhere, Category = "Relevancy")
+	float LightExposureCellSize;
+
+	/** Unlit players are still replicated to anyone within this distance, who can see them by their own PersonalLight. */
+	UPROPERTY(Config, EditAnywhere, Category = "Relevancy")
+	float RevealRadius;
+
+	/** Net priority multiplier for players the viewer cannot currently see */
+	UPROPERTY(Config, EditAnywhere, Category = "Relevancy")
+	float UnrevealedNetPriorityScale;
+
+protected:
+	/** True while seamless travel passes through the transition map, where no match is played */
+	bool IsTransitionMap() const;
+
+	/** Picks where a dead player should come back. Returns null if there is nowhere to spawn. */
+	virtual AActor* ChooseRespawnPoint(ABlackoutCharacter* pawn);
+
+	/** Adds a kill to the feed of everyone who should see it */
+	virtual void AnnounceKill(AController* victim, const FString& killerName, const FString& victimName);
+
+	/** Called once the spectator broadcast is recording, with the controller the recording views the match through */
+	virtual void OnSpectatorBroadcastStarted(APlayerController* recorder) {}
+
+private:
+	UPROPERTY()
+	class ABlackoutServerGovernor* Governor;
+
+	/** Answers beacon queries and reservations, null when not a server */
+	UPROPERTY()
+	class ABlackoutBeaconHostObject* BeaconHostObject;
+
+	FRandomStream GameplayRandom;
+
+	/** Every light that can currently reveal a player */
+	FBlackoutLightExposureGrid LightExposure;
+
+	/** Name to broadcast the match to spectators under, from ?SpectatorBroadcast=. Empty if not broadcasting. */
+	FString spectatorBroadcastName;
 };
 
 
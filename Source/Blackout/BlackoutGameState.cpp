@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutGameState.h"
+#include "BlackoutGameInstance.h"
+#include "Net/UnrealNetwork.h"
+
+void ABlackoutGameState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ABlackoutGameState, KillFeed);
+	DOREPLIFETIME(ABlackoutGameState, NextMap);
+}
+
+void ABlackoutGameState::OnRep_NextMap()
+{
+	if (UBlackoutGameInstance* gameInstance = GetGameInstance<UBlackoutGameInstance>()) {
+		gameInstance->PreloadMap(NextMap);
+	}
+}
@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/GameStateBase.h"
+#include "BlackoutKillFeed.h"
+#include "BlackoutGameState.generated.h"
+
+UCLASS()
+class BLACKOUT_API ABlackoutGameState : public AGameStateBase
+{
+	GENERATED_BODY()
+
+public:
+	/** Recent kills in the match. Arenas keep their own, see ABlackoutArena::KillFeed. */
+	UPROPERTY(Replicated)
+	FBlackoutKillFeed KillFeed;
+
+	/** Map the server rotates to after this one, so clients can preload it too. Empty if there is no rotation. */
+	UPROPERTY(ReplicatedUsing = OnRep_NextMap)
+	FString NextMap;
+
+	void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+private:
+	UFUNCTION()
+	void OnRep_NextMap();
+};
@@ -11,9 +11,12 @@
 #include "Blueprint/WidgetBlueprintLibrary.h"
 #include "Blueprint/UserWidget.h"
 #include "BlackoutCharacter.h"
+#include "BlackoutLoadGenerator.h"
+#include "BlackoutMemory.h"
 
 ABlackoutHUD::ABlackoutHUD()
 {
+	BLACKOUT_LLM_SCOPE(UI);
 	// Set the crosshair texture
 	static ConstructorHelpers::FObjectFinder<UTexture2D> CrosshairTexObj(TEXT("/Game/FirstPerson/Textures/FirstPersonCrosshair"));
 	CrosshairTex = CrosshairTexObj.Object;
@@ -30,26 +33,33 @@ ABlackoutHUD::ABlackoutHUD()
 
 void ABlackoutHUD::BeginPlay()
 {
+	BLACKOUT_LLM_SCOPE(UI);
+	// Headless load clients have nobody to show anything to
+	if (FBlackoutLoadGenerator::IsHeadless()) {
+		return;
+	}
+
+	// Owned by our player and on their part of the screen, so split-screen players each see their own health
 	if (HUDWidgetClass != nullptr)
 	{
-		CurrentWidget = CreateWidget<UUserWidget>(GetWorld(), HUDWidgetClass);
+		CurrentWidget = CreateWidget<UUserWidget>(GetOwningPlayerController(), HUDWidgetClass);
 
 		if (CurrentWidget)
 		{
-			CurrentWidget->AddToViewport();
+			CurrentWidget->AddToPlayerScreen();
 		}
 	}
 
-	if (MenuWidgetClass != nullptr)
-	{
-		MenuWidget = CreateWidget<UUserWidget>(GetWorld(), MenuWidgetClass);
-	}
+	// The pause menu is created the first time it is shown, most players in a split-screen game never open it
 }
 
 
 void ABlackoutHUD::DrawHUD()
 {
 	Super::DrawHUD();
+	if (FBlackoutLoadGenerator::IsHeadless()) {
+		return;
+	}
 
 	// Draw very simple crosshair
 
@@ -76,10 +86,10 @@ void ABlackoutHUD::DrawHUD()
 void ABlackoutHUD::DrawGameOver()
 {
 	
-	UWorld* world = GetWorld();
-	if (world) {
+	if (ABlackoutScheduler* scheduler = ABlackoutScheduler::Get(this)) {
 		drawGameOver = true;
-		world->GetTimerManager().SetTimer(gameOverTimerHandle, this, &ABlackoutHUD::ResumePlayAfterGameOver, gameOverMessageTime, false);
+		ABlackoutScheduler::Cancel(this, gameOverTimerHandle);
+		gameOverTimerHandle = scheduler->SetTimer(EBlackoutTimerCategory::HUD, FSimpleDelegate::CreateUObject(this, &ABlackoutHUD::ResumePlayAfterGameOver), gameOverMessageTime);
 	} else {
 		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, TEXT("!!!Attempted to game over when not spawned. Tell Fred if you ever see this message."));
 	}
@@ -87,9 +97,13 @@ void ABlackoutHUD::DrawGameOver()
 
 void ABlackoutHUD::ShowPauseMenu()
 {
+	if (MenuWidget == nullptr && MenuWidgetClass != nullptr) {
+		BLACKOUT_LLM_SCOPE(UI);
+		MenuWidget = CreateWidget<UUserWidget>(GetOwningPlayerController(), MenuWidgetClass);
+	}
 	if (MenuWidget != nullptr) {
 		UWidgetBlueprintLibrary::SetInputMode_GameAndUI(GetOwningPlayerController(), MenuWidget);
-		MenuWidget->AddToViewport();
+		MenuWidget->AddToPlayerScreen();
 	}
 	GetOwningPlayerController()->bShowMouseCursor = true;
 	
@@ -121,3 +135,12 @@ void ABlackoutHUD::TogglePaused()
 		HidePauseMenu();
 	}
 }
+
+void ABlackoutHUD::ResetHUD()
+{
+	drawGameOver = false;
+	ABlackoutScheduler::Cancel(this, gameOverTimerHandle);
+	if (paused) {
+		TogglePaused();
+	}
+}
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/HUD.h"
 #include "Blueprint/UserWidget.h"
+#include "BlackoutScheduler.h"
 #include "BlackoutHUD.generated.h"
 
 UCLASS()
@@ -27,6 +28,11 @@ public:
 	void HidePauseMenu();
 
 	void TogglePaused();
+
+	FORCEINLINE bool IsPaused() const { return paused; }
+
+	/** Clears the game over message and closes the pause menu, as at the start of a match */
+	void ResetHUD();
 	
 
 protected:
@@ -55,7 +61,7 @@ private:
 	float gameOverMessageTime = 1.5f;
 
 	bool drawGameOver = false;
-	FTimerHandle gameOverTimerHandle;
+	FBlackoutTimerHandle gameOverTimerHandle;
 
 	/** True when the pause menu is shown */
 	bool paused = false;
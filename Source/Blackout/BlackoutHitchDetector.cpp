@@ -0,0 +1,183 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutHitchDetector.h"
+#include "Blackout.h"
+#include "BlackoutMemory.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectGlobals.h"
+
+static TAutoConsoleVariable<float> CVarHitchThreshold(
+	TEXT("Blackout.Hitch.ThresholdMs"),
+	150.f,
+	TEXT("Frames longer than this are written to Saved/Profiling/Hitches with the frames around them. 0 disables."),
+	ECVF_Default);
+
+FBlackoutHitchDetector& FBlackoutHitchDetector::Get()
+{
+	static FBlackoutHitchDetector instance;
+	return instance;
+}
+
+void FBlackoutHitchDetector::Start()
+{
+	if (started) {
+		return;
+	}
+	started = true;
+	BLACKOUT_LLM_SCOPE(Telemetry);
+	frames.SetNum(FramesBefore + FramesAfter);
+	events.Reserve(MaxEvents);
+
+	handles.Add(FCoreDelegates::OnEndFrame.AddRaw(this, &FBlackoutHitchDetector::OnEndFrame));
+	handles.Add(FCoreDelegates::OnSyncLoadPackage.AddRaw(this, &FBlackoutHitchDetector::OnSyncLoadPackage));
+	handles.Add(FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddRaw(this, &FBlackoutHitchDetector::OnPreGarbageCollect));
+	handles.Add(FCoreUObjectDelegates::GetPostGarbageCollect().AddRaw(this, &FBlackoutHitchDetector::OnPostGarbageCollect));
+	handles.Add(FWorldDelegates::OnPostWorldInitialization.AddLambda([this](UWorld* world, const UWorld::InitializationValues) {
+		HookWorld(world);
+	}));
+	handles.Add(FWorldDelegates::OnWorldCleanup.AddRaw(this, &FBlackoutHitchDetector::OnWorldCleanup));
+
+	// Worlds created before the game instance, such as the one it is initialized in, count spawns too
+	if (GEngine) {
+		for (const FWorldContext& context : GEngine->GetWorldContexts()) {
+			HookWorld(context.World());
+		}
+	}
+}
+
+void FBlackoutHitchDetector::Stop()
+{
+	if (!started) {
+		return;
+	}
+	started = false;
+	FCoreDelegates::OnEndFrame.Remove(handles[0]);
+	FCoreDelegates::OnSyncLoadPackage.Remove(handles[1]);
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(handles[2]);
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(handles[3]);
+	FWorldDelegates::OnPostWorldInitialization.Remove(handles[4]);
+	FWorldDelegates::OnWorldCleanup.Remove(handles[5]);
+	handles.Reset();
+
+	for (const TPair<TWeakObjectPtr<UWorld>, FDelegateHandle>& pair : spawnHandles) {
+		if (UWorld* world = pair.Key.Get()) {
+			world->RemoveOnActorSpawnedHandler(pair.Value);
+		}
+	}
+	spawnHandles.Reset();
+}
+
+void FBlackoutHitchDetector::HookWorld(UWorld* world)
+{
+	if (world && world->IsGameWorld() && !spawnHandles.Contains(world)) {
+		spawnHandles.Add(world, world->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateRaw(this, &FBlackoutHitchDetector::OnActorSpawned)));
+	}
+}
+
+void FBlackoutHitchDetector::OnWorldCleanup(UWorld* world, bool sessionEnded, bool cleanupResources)
+{
+	FDelegateHandle handle;
+	if (spawnHandles.RemoveAndCopyValue(world, handle)) {
+		world->RemoveOnActorSpawnedHandler(handle);
+	}
+}
+
+void FBlackoutHitchDetector::Mark(const TCHAR* name)
+{
+	if (started) {
+		AddEvent(TEXT("Mark"), name);
+	}
+}
+
+void FBlackoutHitchDetector::OnEndFrame()
+{
+	current.Frame = GFrameCounter;
+	current.FrameMs = FApp::GetDeltaTime() * 1000.0;
+	current.BusyMs = FMath::Max(0.0, FApp::GetDeltaTime() - FApp::GetIdleTime()) * 1000.0;
+	frames[nextFrame] = current;
+	nextFrame = (nextFrame + 1) % frames.Num();
+
+	const float threshold = CVarHitchThreshold.GetValueOnGameThread();
+	if (hitchFrame == 0 && threshold > 0.f && current.FrameMs > threshold) {
+		hitchFrame = current.Frame;
+		hitchMs = current.FrameMs;
+	}
+	if (hitchFrame != 0 && current.Frame >= hitchFrame + FramesAfter) {
+		Dump();
+		hitchFrame = 0;
+	}
+
+	current = FFrame();
+}
+
+void FBlackoutHitchDetector::OnPreGarbageCollect()
+{
+	gcStart = FPlatformTime::Seconds();
+}
+
+void FBlackoutHitchDetector::OnPostGarbageCollect()
+{
+	const float ms = (FPlatformTime::Seconds() - gcStart) * 1000.0;
+	current.GCMs += ms;
+	AddEvent(TEXT("GC"), FString::Printf(TEXT("%.2f ms"), ms));
+}
+
+void FBlackoutHitchDetector::OnSyncLoadPackage(const FString& packageName)
+{
+	current.SyncLoads++;
+	AddEvent(TEXT("SyncLoad"), packageName);
+}
+
+void FBlackoutHitchDetector::OnActorSpawned(AActor* actor)
+{
+	current.Spawns++;
+}
+
+void FBlackoutHitchDetector::AddEvent(const TCHAR* kind, const FString& name)
+{
+	BLACKOUT_LLM_SCOPE(Telemetry);
+	FEvent event{ GFrameCounter, kind, name };
+	if (events.Num() < MaxEvents) {
+		events.Add(MoveTemp(event));
+	}
+	else {
+		events[nextEvent] = MoveTemp(event);
+	}
+	nextEvent = (nextEvent + 1) % MaxEvents;
+}
+
+void FBlackoutHitchDetector::Dump()
+{
+	FString csv = FString::Printf(TEXT("# Hitch of %.1f ms on frame %llu\nFrame,FrameMs,BusyMs,GCMs,SyncLoads,Spawns\n"), hitchMs, hitchFrame);
+	const uint64 firstFrame = hitchFrame > FramesBefore ? hitchFrame - FramesBefore : 0;
+	for (int32 i = 0; i < frames.Num(); i++) {
+		// Oldest first
+		const FFrame& frame = frames[(nextFrame + i) % frames.Num()];
+		if (frame.Frame != 0 && frame.Frame >= firstFrame) {
+			csv += FString::Printf(TEXT("%llu,%.2f,%.2f,%.2f,%d,%d\n"), frame.Frame, frame.FrameMs, frame.BusyMs, frame.GCMs, frame.SyncLoads, frame.Spawns);
+		}
+	}
+
+	csv += TEXT("Frame,Event,Detail\n");
+	for (int32 i = 0; i < events.Num(); i++) {
+		const FEvent& event = events[(events.Num() < MaxEvents ? i : (nextEvent + i) % MaxEvents)];
+		if (event.Frame >= firstFrame) {
+			csv += FString::Printf(TEXT("%llu,%s,%s\n"), event.Frame, event.Kind, *event.Name);
+		}
+	}
+
+	const FString path = FPaths::Combine(FPaths::ProfilingDir(), TEXT("Hitches"),
+		FString::Printf(TEXT("Hitch_%s_%llu.csv"), *FDateTime::Now().ToString(), hitchFrame));
+	FFileHelper::SaveStringToFile(csv, *path);
+	UE_LOG(LogBlackout, Warning, TEXT("Hitch of %.1f ms on frame %llu, wrote %s"), hitchMs, hitchFrame, *path);
+}
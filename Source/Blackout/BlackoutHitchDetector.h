@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+class UWorld;
+
+/**
+ * Always-on hitch detector. Keeps a rolling record of the last frames (frame time, busy time, garbage collection,
+ * synchronous loads, actor spawns and marked gameplay events) and, when a frame takes longer than
+ * `Blackout.Hitch.ThresholdMs`, writes the frames around it to Saved/Profiling/Hitches/ once the frames after
+ * it have been recorded too. Costs a few stores per frame, and works the same on dedicated servers.
+ */
+class BLACKOUT_API FBlackoutHitchDetector
+{
+public:
+	static FBlackoutHitchDetector& Get();
+
+	/** Hooks into the engine. Called once by UBlackoutGameInstance::Init. */
+	void Start();
+	void Stop();
+
+	/** Records a gameplay event in the current frame, e.g. a respawn */
+	void Mark(const TCHAR* name);
+
+private:
+	struct FFrame
+	{
+		uint64 Frame = 0;
+		float FrameMs = 0.f;
+		float BusyMs = 0.f;
+		float GCMs = 0.f;
+		uint16 SyncLoads = 0;
+		uint16 Spawns = 0;
+	};
+
+	struct FEvent
+	{
+		uint64 Frame;
+		const TCHAR* Kind;
+		FString Name;
+	};
+
+	/** Frames kept from before a hitch */
+	static const int32 FramesBefore = 120;
+	/** Frames recorded after a hitch before it is written */
+	static const int32 FramesAfter = 30;
+	/** Events kept, covering the same frames */
+	static const int32 MaxEvents = 256;
+
+	void OnEndFrame();
+	void OnPreGarbageCollect();
+	void OnPostGarbageCollect();
+	void OnSyncLoadPackage(const FString& packageName);
+	void OnActorSpawned(AActor* actor);
+
+	/** Counts a game world's actor spawns, once per world */
+	void HookWorld(UWorld* world);
+
+	/** Stops counting spawns in a world that is going away */
+	void OnWorldCleanup(UWorld* world, bool sessionEnded, bool cleanupResources);
+	void AddEvent(const TCHAR* kind, const FString& name);
+
+	/** Writes every frame and event in the buffers */
+	void Dump();
+
+	TArray<FFrame> frames;
+	TArray<FEvent> events;
+	int32 nextFrame = 0;
+	int32 nextEvent = 0;
+
+	/** The frame being recorded */
+	FFrame current;
+
+	double gcStart = 0;
+
+	/** Frame the pending hitch happened on, 0 if nothing is waiting to be written */
+	uint64 hitchFrame = 0;
+	float hitchMs = 0.f;
+
+	bool started = false;
+	TArray<FDelegateHandle> handles;
+
+	/** Actor spawned handler of each hooked world, removed on world cleanup or Stop */
+	TMap<TWeakObjectPtr<UWorld>, FDelegateHandle> spawnHandles;
+};
@@ -0,0 +1,304 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutInputRecorder.h"
+#include "Blackout.h"
+#include "BlackoutCharacter.h"
+#include "BlackoutGameMode.h"
+#include "BlackoutMemory.h"
+#include "BlackoutPlayerState.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+static FAutoConsoleCommandWithWorld InputStopCommand(
+	TEXT("Blackout.Input.Stop"),
+	TEXT("Stops and saves the input recording"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		FBlackoutInputRecorder::Get().StopRecording(World);
+	}));
+
+FBlackoutInputRecorder& FBlackoutInputRecorder::Get()
+{
+	static FBlackoutInputRecorder instance;
+	return instance;
+}
+
+FString FBlackoutInputRecorder::GetPath(const FString& name)
+{
+	if (name.EndsWith(TEXT(".csv"))) {
+		return name;
+	}
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("InputRecordings"), name + TEXT(".csv"));
+}
+
+void FBlackoutInputRecorder::StartFromCommandLine()
+{
+	FString name;
+	if (FParse::Value(FCommandLine::Get(), TEXT("InputRecord="), name)) {
+		StartRecording(name);
+	}
+	else if (FParse::Value(FCommandLine::Get(), TEXT("InputReplay="), name) && !StartReplay(name) && FParse::Param(FCommandLine::Get(), TEXT("InputReplayExit"))) {
+		FPlatformMisc::RequestExitWithStatus(false, 1);
+	}
+}
+
+void FBlackoutInputRecorder::StartRecording(const FString& name)
+{
+	if (IsReplaying()) {
+		UE_LOG(LogBlackout, Warning, TEXT("Can't record input while replaying it"));
+		return;
+	}
+	state = EState::Recording;
+	recordingName = name;
+	frames.Reset();
+	trackedController.Reset();
+	hasSeed = false;
+	UE_LOG(LogBlackout, Display, TEXT("Recording input to %s"), *GetPath(name));
+}
+
+void FBlackoutInputRecorder::StopRecording(UWorld* world)
+{
+	if (!IsRecording()) {
+		return;
+	}
+	state = EState::Idle;
+
+	FString csv;
+	csv += FString::Printf(TEXT("# Map=%s\n"), *mapName);
+	if (hasSeed) {
+		csv += FString::Printf(TEXT("# Seed=%d\n"), seed);
+	}
+	if (world) {
+		csv += FString::Printf(TEXT("# Fingerprint=%u\n"), Fingerprint(world));
+	}
+	csv += TEXT("DeltaSeconds,MoveForward,MoveRight,Turn,TurnRate,LookUp,LookUpRate,Actions\n");
+
+	// %.9g round trips a float exactly, replays have to get back the very same values
+	for (const FBlackoutInputFrame& frame : frames) {
+		csv += FString::Printf(TEXT("%.9g"), frame.DeltaSeconds);
+		for (float axis : frame.Axes) {
+			csv += FString::Printf(TEXT(",%.9g"), axis);
+		}
+		csv += FString::Printf(TEXT(",%d\n"), frame.Actions);
+	}
+
+	const FString path = GetPath(recordingName);
+	FFileHelper::SaveStringToFile(csv, *path);
+	UE_LOG(LogBlackout, Display, TEXT("Wrote %d frames of input to %s"), frames.Num(), *path);
+	frames.Reset();
+}
+
+bool FBlackoutInputRecorder::StartReplay(const FString& name)
+{
+	const FString path = GetPath(name);
+	TArray<FString> lines;
+	if (!FFileHelper::LoadFileToStringArray(lines, *path)) {
+		UE_LOG(LogBlackout, Error, TEXT("Can't read input recording %s"), *path);
+		return false;
+	}
+
+	frames.Reset();
+	mapName.Empty();
+	hasSeed = false;
+	hasFingerprint = false;
+	openedReplayMap = false;
+	for (const FString& line : lines) {
+		if (line.StartsWith(TEXT("#"))) {
+			FParse::Value(*line, TEXT("Map="), mapName);
+			hasSeed |= FParse::Value(*line, TEXT("Seed="), seed);
+			hasFingerprint |= FParse::Value(*line, TEXT("Fingerprint="), expectedFingerprint);
+			continue;
+		}
+
+		TArray<FString> values;
+		line.ParseIntoArray(values, TEXT(","));
+		if (values.Num() != (int32)EBlackoutInputAxis::Count + 2 || !values[0].IsNumeric()) {
+			continue;
+		}
+		FBlackoutInputFrame& frame = frames.AddDefaulted_GetRef();
+		frame.DeltaSeconds = FCString::Atof(*values[0]);
+		for (int32 i = 0; i < (int32)EBlackoutInputAxis::Count; i++) {
+			frame.Axes[i] = FCString::Atof(*values[i + 1]);
+		}
+		frame.Actions = (uint8)FCString::Atoi(*values.Last());
+	}
+	if (frames.Num() == 0) {
+		UE_LOG(LogBlackout, Error, TEXT("Input recording %s has no frames"), *path);
+		return false;
+	}
+
+	state = EState::Replaying;
+	replayIndex = 0;
+	trackedController.Reset();
+
+	// Every frame takes exactly as long as it did when recorded, however long it really takes here
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(frames[0].DeltaSeconds);
+	UE_LOG(LogBlackout, Display, TEXT("Replaying %d frames of input from %s on %s"), frames.Num(), *path, *mapName);
+	return true;
+}
+
+bool FBlackoutInputRecorder::GetReplaySeed(int32& outSeed) const
+{
+	if (!IsReplaying() || !hasSeed) {
+		return false;
+	}
+	outSeed = seed;
+	return true;
+}
+
+bool FBlackoutInputRecorder::IsTracked(APlayerController* playerController)
+{
+	// Seamless travel keeps the controller, but the recording ends with its map all the same
+	if (IsRecording() && trackedController.Get() == playerController && playerController->GetWorld() != trackedWorld.Get()) {
+		UE_LOG(LogBlackout, Warning, TEXT("Left the recorded map, input recording stops"));
+		StopRecording(nullptr);
+		return false;
+	}
+
+	if (!trackedController.IsValid() && playerController->IsLocalController()) {
+		UWorld* world = playerController->GetWorld();
+		const FString currentMap = UGameplayStatics::GetCurrentLevelName(world, true);
+
+		if (IsRecording()) {
+			// A recording covers one match from its first frame, anything else can't be replayed from a map start
+			if (frames.Num() > 0) {
+				UE_LOG(LogBlackout, Warning, TEXT("Left the recorded map, input recording stops"));
+				StopRecording(nullptr);
+				return false;
+			}
+			// Wait for a map with the game mode, e.g. past the main menu, its seed is what makes replays repeat
+			const ABlackoutGameMode* gameMode = world->GetAuthGameMode<ABlackoutGameMode>();
+			if (!gameMode) {
+				return false;
+			}
+			mapName = currentMap;
+			hasSeed = true;
+			seed = gameMode->GetGameplayRandom().GetInitialSeed();
+		}
+		else if (!mapName.IsEmpty() && currentMap != mapName) {
+			// The recorded input only means anything on the map it was recorded on
+			if (!openedReplayMap) {
+				openedReplayMap = true;
+				UE_LOG(LogBlackout, Display, TEXT("Input recording was made on %s, opening it"), *mapName);
+				UGameplayStatics::OpenLevel(world, FName(*mapName));
+			}
+			else {
+				UE_LOG(LogBlackout, Error, TEXT("Input recording was made on %s, but %s is loaded"), *mapName, *currentMap);
+				FinishReplay(world, false);
+			}
+			return false;
+		}
+		trackedController = playerController;
+		trackedWorld = world;
+	}
+	return trackedController.Get() == playerController;
+}
+
+void FBlackoutInputRecorder::RecordAxis(const APawn* pawn, EBlackoutInputAxis axis, float value)
+{
+	if (IsRecording() && pawn && pawn->GetController() == trackedController.Get()) {
+		current.Axes[(int32)axis] = value;
+	}
+}
+
+void FBlackoutInputRecorder::RecordAction(const APawn* pawn, EBlackoutInputAction action)
+{
+	if (IsRecording() && pawn && pawn->GetController() == trackedController.Get()) {
+		current.Actions |= 1 << (int32)action;
+	}
+}
+
+void FBlackoutInputRecorder::BeginFrame(APlayerController* playerController)
+{
+	if (state == EState::Idle || !IsTracked(playerController)) {
+		return;
+	}
+
+	if (IsRecording()) {
+		// Input handlers called outside the controller's tick, e.g. by the autopilot, are not recorded
+		current = FBlackoutInputFrame();
+		return;
+	}
+
+	if (replayIndex >= frames.Num()) {
+		FinishReplay(playerController->GetWorld(), true);
+		return;
+	}
+	if (ABlackoutCharacter* character = Cast<ABlackoutCharacter>(playerController->GetPawn())) {
+		character->ReplayInput(frames[replayIndex]);
+	}
+}
+
+void FBlackoutInputRecorder::EndFrame(APlayerController* playerController, float deltaSeconds)
+{
+	if (state == EState::Idle || trackedController.Get() != playerController) {
+		return;
+	}
+
+	if (IsRecording()) {
+		BLACKOUT_LLM_SCOPE(Telemetry);
+		current.DeltaSeconds = deltaSeconds;
+		frames.Add(current);
+		return;
+	}
+
+	replayIndex++;
+	if (replayIndex < frames.Num()) {
+		FApp::SetFixedDeltaTime(frames[replayIndex].DeltaSeconds);
+	}
+}
+
+void FBlackoutInputRecorder::FinishReplay(UWorld* world, bool played)
+{
+	state = EState::Idle;
+	FApp::SetUseFixedTimeStep(false);
+
+	const uint32 fingerprint = Fingerprint(world);
+	const bool matched = played && (!hasFingerprint || fingerprint == expectedFingerprint);
+	if (!played) {
+		UE_LOG(LogBlackout, Error, TEXT("Input replay did not run"));
+	}
+	else if (hasFingerprint) {
+		UE_LOG(LogBlackout, Display, TEXT("Input replay finished after %d frames, fingerprint %u %s recorded %u"),
+			frames.Num(), fingerprint, matched ? TEXT("matches") : TEXT("DIFFERS from"), expectedFingerprint);
+	}
+	else {
+		UE_LOG(LogBlackout, Display, TEXT("Input replay finished after %d frames, fingerprint %u"), frames.Num(), fingerprint);
+	}
+	frames.Reset();
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("InputReplayExit"))) {
+		FPlatformMisc::RequestExitWithStatus(false, matched ? 0 : 1);
+	}
+}
+
+uint32 FBlackoutInputRecorder::Fingerprint(UWorld* world)
+{
+	uint32 crc = 0;
+	if (!world) {
+		return crc;
+	}
+	for (TActorIterator<ABlackoutCharacter> it(world); it; ++it) {
+		// Whole centimetres, so the fingerprint only changes when the match does
+		const FIntVector location(it->GetActorLocation());
+		const ABlackoutPlayerState* playerState = it->GetPlayerState<ABlackoutPlayerState>();
+		const int32 values[] = {
+			location.X, location.Y, location.Z,
+			it->GetCurrentHealth(), it->GetAmmo(),
+			playerState ? playerState->Kills : 0, playerState ? playerState->Deaths : 0
+		};
+		crc = FCrc::MemCrc32(values, sizeof(values), crc);
+	}
+	return crc;
+}
@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class APawn;
+class APlayerController;
+class UWorld;
+
+/** Axes bound in ABlackoutCharacter::SetupPlayerInputComponent */
+enum class EBlackoutInputAxis : uint8
+{
+	MoveForward,
+	MoveRight,
+	Turn,
+	TurnRate,
+	LookUp,
+	LookUpRate,
+	Count
+};
+
+/** Action events bound in ABlackoutCharacter::SetupPlayerInputComponent, in the order they are replayed */
+enum class EBlackoutInputAction : uint8
+{
+	JumpPressed,
+	JumpReleased,
+	FirePressed,
+	PausePressed,
+	Count
+};
+
+/** Everything the local player's input bindings did during one frame */
+struct FBlackoutInputFrame
+{
+	/** World delta time of the frame */
+	float DeltaSeconds = 0.f;
+	float Axes[(int32)EBlackoutInputAxis::Count] = {};
+	/** One bit per EBlackoutInputAction */
+	uint8 Actions = 0;
+
+	FORCEINLINE bool HasAction(EBlackoutInputAction action) const { return (Actions & (1 << (int32)action)) != 0; }
+};
+
+/**
+ * Records the first local player's bound input, frame by frame, and plays it back through the same handlers.
+ *
+ * -InputRecord=<name> captures every axis value and action event together with the frame's delta time, from the first
+ * player controller tick on the first map with ABlackoutGameMode until `Blackout.Input.Stop` or the end of that map,
+ * and saves Saved/InputRecordings/<name>.csv along with the map, the gameplay seed (see
+ * ABlackoutGameMode::GetGameplayRandom) and a fingerprint of the match state at the end. There is no console command
+ * to start recording: a replay starts from a fresh map, so a recording has to as well.
+ *
+ * -InputReplay=<name> starts the map with the recorded seed and, from the first player controller tick, feeds the
+ * recorded frames back in with a fixed time step of each recorded delta, so a standalone run (e.g. with -nullrhi)
+ * plays the same match every time. If another map is loaded the recorded one is opened first, and the replay fails
+ * if that doesn't work. When the recording runs out the fingerprint is compared with the recorded one; with
+ * -InputReplayExit the game then exits with 0 if they match and 1 if not.
+ */
+class BLACKOUT_API FBlackoutInputRecorder
+{
+public:
+	static FBlackoutInputRecorder& Get();
+
+	/** Starts recording or replaying if asked to on the command line. Called once by UBlackoutGameInstance::Init. */
+	void StartFromCommandLine();
+
+	void StartRecording(const FString& name);
+
+	/** Saves the recording. `world` is used for the end fingerprint and may be null, e.g. on shutdown. */
+	void StopRecording(UWorld* world);
+
+	/** Loads a recording and replays it from the next player controller tick. Returns false if it can't be read. */
+	bool StartReplay(const FString& name);
+
+	FORCEINLINE bool IsRecording() const { return state == EState::Recording; }
+	FORCEINLINE bool IsReplaying() const { return state == EState::Replaying; }
+
+	/** Seed the loaded recording was made with, or false if not replaying one that knows its seed */
+	bool GetReplaySeed(int32& outSeed) const;
+
+	/** Called by the input handlers of the locally controlled character */
+	void RecordAxis(const APawn* pawn, EBlackoutInputAxis axis, float value);
+	void RecordAction(const APawn* pawn, EBlackoutInputAction action);
+
+	/** Called by ABlackoutPlayerController::PlayerTick before and after input is processed */
+	void BeginFrame(APlayerController* playerController);
+	void EndFrame(APlayerController* playerController, float deltaSeconds);
+
+	/** Hash of every character's position, health and score, to tell whether two runs ended in the same state */
+	static uint32 Fingerprint(UWorld* world);
+
+private:
+	enum class EState : uint8
+	{
+		Idle,
+		Recording,
+		Replaying
+	};
+
+	/** True if this is the controller being recorded or replayed, adopting the first local one to ask */
+	bool IsTracked(APlayerController* playerController);
+
+	/** `played` is false if the replay couldn't run at all, which counts as a mismatch */
+	void FinishReplay(UWorld* world, bool played);
+
+	static FString GetPath(const FString& name);
+
+	EState state = EState::Idle;
+
+	/** Player controller whose input is recorded or replayed, the first local one to tick */
+	TWeakObjectPtr<APlayerController> trackedController;
+
+	/** World the tracked controller was adopted in */
+	TWeakObjectPtr<UWorld> trackedWorld;
+
+	FString recordingName;
+	TArray<FBlackoutInputFrame> frames;
+
+	/** Frame being recorded */
+	FBlackoutInputFrame current;
+
+	/** Next frame to replay */
+	int32 replayIndex = 0;
+
+	FString mapName;
+	int32 seed = 0;
+	bool hasSeed = false;
+	uint32 expectedFingerprint = 0;
+	bool hasFingerprint = false;
+
+	/** True once the replay has opened the recorded map, so a map that won't load isn't opened forever */
+	bool openedReplayMap = false;
+};
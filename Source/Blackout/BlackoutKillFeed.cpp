@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutKillFeed.h"
+#include "Engine/Engine.h"
+
+void FBlackoutKill::Show() const
+{
+	const FString message = KillerName.IsEmpty()
+		? FString::Printf(TEXT("%s has been blacked out."), *VictimName)
+		: FString::Printf(TEXT("%s has blacked out %s."), *KillerName, *VictimName);
+	GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, message);
+}
+
+void FBlackoutKill::PostReplicatedAdd(const FBlackoutKillFeed& InArraySerializer)
+{
+	Show();
+}
+
+void FBlackoutKillFeed::AddKill(const FString& killerName, const FString& victimName)
+{
+	if (Kills.Num() >= MaxKills) {
+		Kills.RemoveAt(0, Kills.Num() - MaxKills + 1);
+		MarkArrayDirty();
+	}
+
+	FBlackoutKill& kill = Kills.AddDefaulted_GetRef();
+	kill.KillerName = killerName;
+	kill.VictimName = victimName;
+	MarkItemDirty(kill);
+}
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "BlackoutKillFeed.generated.h"
+
+/** One line of the kill feed */
+USTRUCT()
+struct FBlackoutKill : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	/** Empty if nobody gets the credit */
+	UPROPERTY()
+	FString KillerName;
+
+	UPROPERTY()
+	FString VictimName;
+
+	/** Shows the kill on screen */
+	void Show() const;
+
+	void PostReplicatedAdd(const struct FBlackoutKillFeed& InArraySerializer);
+};
+
+/**
+ * The last few kills, replicated with fast array delta serialization: adding a kill sends that one entry and
+ * dropping the oldest sends only its removal, however long the match has been running.
+ */
+USTRUCT()
+struct FBlackoutKillFeed : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	/** Most kills kept at once, older ones are dropped */
+	static const int32 MaxKills = 8;
+
+	/** Appends a kill, dropping the oldest if the feed is full. Server only. */
+	void AddKill(const FString& killerName, const FString& victimName);
+
+	const TArray<FBlackoutKill>& GetKills() const { return Kills; }
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FBlackoutKill, FBlackoutKillFeed>(Kills, DeltaParms, *this);
+	}
+
+private:
+	UPROPERTY()
+	TArray<FBlackoutKill> Kills;
+};
+
+template<>
+struct TStructOpsTypeTraits<FBlackoutKillFeed> : public TStructOpsTypeTraitsBase2<FBlackoutKillFeed>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
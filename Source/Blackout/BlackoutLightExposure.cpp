@@ -0,0 +1,181 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutLightExposure.h"
+#include "Blackout.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+
+FBlackoutLightExposureGrid::FBlackoutLightExposureGrid(float cellSize)
+	: CellSize(cellSize)
+{
+}
+
+void FBlackoutLightExposureGrid::Reset(float cellSize)
+{
+	CellSize = cellSize;
+	Lights.Empty();
+	Cells.Empty();
+}
+
+FIntPoint FBlackoutLightExposureGrid::ToCell(const FVector& location) const
+{
+	return FIntPoint(FMath::FloorToInt(location.X / CellSize), FMath::FloorToInt(location.Y / CellSize));
+}
+
+int32 FBlackoutLightExposureGrid::AddLight(const FVector& location, float radius)
+{
+	FLight light;
+	light.Location = location;
+	light.Radius = radius;
+	light.MinCell = ToCell(location - FVector(radius));
+	light.MaxCell = ToCell(location + FVector(radius));
+
+	const int32 handle = Lights.Add(light);
+	LinkCells(handle, light);
+	return handle;
+}
+
+void FBlackoutLightExposureGrid::UpdateLight(int32 handle, const FVector& location)
+{
+	if (!Lights.IsValidIndex(handle)) {
+		return;
+	}
+
+	FLight& light = Lights[handle];
+	light.Location = location;
+
+	const FIntPoint minCell = ToCell(location - FVector(light.Radius));
+	const FIntPoint maxCell = ToCell(location + FVector(light.Radius));
+	if (minCell == light.MinCell && maxCell == light.MaxCell) {
+		// Still covers the same cells, nothing to rehash
+		return;
+	}
+
+	UnlinkCells(handle, light);
+	light.MinCell = minCell;
+	light.MaxCell = maxCell;
+	LinkCells(handle, light);
+}
+
+void FBlackoutLightExposureGrid::RemoveLight(int32 handle)
+{
+	if (!Lights.IsValidIndex(handle)) {
+		return;
+	}
+	UnlinkCells(handle, Lights[handle]);
+	Lights.RemoveAt(handle);
+}
+
+bool FBlackoutLightExposureGrid::IsLit(const FVector& location) const
+{
+	const TArray<int32>* cell = Cells.Find(ToCell(location));
+	if (!cell) {
+		return false;
+	}
+
+	for (int32 handle : *cell) {
+		const FLight& light = Lights[handle];
+		if (FVector::DistSquared(light.Location, location) <= FMath::Square(light.Radius)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void FBlackoutLightExposureGrid::LinkCells(int32 handle, const FLight& light)
+{
+	for (int32 x = light.MinCell.X; x <= light.MaxCell.X; x++) {
+		for (int32 y = light.MinCell.Y; y <= light.MaxCell.Y; y++) {
+			Cells.FindOrAdd(FIntPoint(x, y)).Add(handle);
+		}
+	}
+}
+
+void FBlackoutLightExposureGrid::UnlinkCells(int32 handle, const FLight& light)
+{
+	for (int32 x = light.MinCell.X; x <= light.MaxCell.X; x++) {
+		for (int32 y = light.MinCell.Y; y <= light.MaxCell.Y; y++) {
+			const FIntPoint key(x, y);
+			if (TArray<int32>* cell = Cells.Find(key)) {
+				cell->RemoveSingleSwap(handle, false);
+				if (cell->Num() == 0) {
+					Cells.Remove(key);
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Blackout.LightExposure.Benchmark [Lights] [Players] [Frames]
+ * Moves Lights projectile-speed lights around a Zap sized area and asks, for every pair of players, whether the
+ * other one is lit. This is the same work the server does per frame while replicating.
+ */
+static FAutoConsoleCommand BenchmarkLightExposureCommand(
+	TEXT("Blackout.LightExposure.Benchmark"),
+	TEXT("Times the light exposure grid. Usage: Blackout.LightExposure.Benchmark [Lights=256] [Players=64] [Frames=600]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 numLights = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 256;
+		const int32 numPlayers = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 64;
+		const int32 numFrames = Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 600;
+
+		const float extent = 20000.f;
+		const float frameTime = 1.f / 30.f;
+		const float lightSpeed = 10000.f;
+		FRandomStream random(1234);
+
+		FBlackoutLightExposureGrid grid;
+		TArray<int32> handles;
+		TArray<FVector> lightLocations;
+		TArray<FVector> lightVelocities;
+		for (int32 i = 0; i < numLights; i++) {
+			lightLocations.Add(FVector(random.FRandRange(-extent, extent), random.FRandRange(-extent, extent), 100.f));
+			lightVelocities.Add(FVector(random.GetUnitVector().GetSafeNormal2D() * lightSpeed));
+			handles.Add(grid.AddLight(lightLocations[i], 2500.f));
+		}
+
+		TArray<FVector> players;
+		for (int32 i = 0; i < numPlayers; i++) {
+			players.Add(FVector(random.FRandRange(-extent, extent), random.FRandRange(-extent, extent), 100.f));
+		}
+
+		double updateSeconds = 0;
+		double querySeconds = 0;
+		int64 litCount = 0;
+		for (int32 frame = 0; frame < numFrames; frame++) {
+			double start = FPlatformTime::Seconds();
+			for (int32 i = 0; i < numLights; i++) {
+				lightLocations[i] += lightVelocities[i] * frameTime;
+				if (FMath::Abs(lightLocations[i].X) > extent || FMath::Abs(lightLocations[i].Y) > extent) {
+					// Expire and refire, like a projectile running out its lifespan
+					grid.RemoveLight(handles[i]);
+					lightLocations[i] = FVector(random.FRandRange(-extent, extent), random.FRandRange(-extent, extent), 100.f);
+					handles[i] = grid.AddLight(lightLocations[i], 2500.f);
+				}
+				else {
+					grid.UpdateLight(handles[i], lightLocations[i]);
+				}
+			}
+			updateSeconds += FPlatformTime::Seconds() - start;
+
+			// Relevancy asks once per (connection, character) pair
+			start = FPlatformTime::Seconds();
+			for (int32 viewer = 0; viewer < numPlayers; viewer++) {
+				for (int32 target = 0; target < numPlayers; target++) {
+					if (viewer != target && grid.IsLit(players[target])) {
+						litCount++;
+					}
+				}
+			}
+			querySeconds += FPlatformTime::Seconds() - start;
+		}
+
+		UE_LOG(LogBlackout, Display, TEXT("Light exposure: %d lights, %d players, %d frames. Update %.4f ms/frame, queries %.4f ms/frame, %.1f%% of pairs lit"),
+			numLights, numPlayers, numFrames,
+			updateSeconds * 1000.0 / numFrames, querySeconds * 1000.0 / numFrames,
+			100.0 * litCount / FMath::Max<int64>(1, (int64)numFrames * numPlayers * (numPlayers - 1)));
+	})
+);
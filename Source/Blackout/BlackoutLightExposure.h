@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/SparseArray.h"
+
+/**
+ * Server side spatial hash of the lights that can reveal players (projectile lights, mostly).
+ * Lights are bucketed into square XY cells. Moving a light only touches the hash when it crosses into a
+ * different set of cells, so keeping the grid up to date costs almost nothing per projectile per frame.
+ */
+class BLACKOUT_API FBlackoutLightExposureGrid
+{
+public:
+	explicit FBlackoutLightExposureGrid(float cellSize = 2500.f);
+
+	/** Adds a light and returns the handle used to move or remove it. */
+	int32 AddLight(const FVector& location, float radius);
+
+	/** Moves a light. Cheap unless the light's footprint changes cells. */
+	void UpdateLight(int32 handle, const FVector& location);
+
+	void RemoveLight(int32 handle);
+
+	/** True if `location` is inside the radius of any light */
+	bool IsLit(const FVector& location) const;
+
+	FORCEINLINE int32 NumLights() const { return Lights.Num(); }
+
+	/** Removes every light and changes the cell size */
+	void Reset(float cellSize);
+
+private:
+	struct FLight
+	{
+		FVector Location;
+		float Radius;
+		FIntPoint MinCell;
+		FIntPoint MaxCell;
+	};
+
+	FIntPoint ToCell(const FVector& location) const;
+
+	void LinkCells(int32 handle, const FLight& light);
+	void UnlinkCells(int32 handle, const FLight& light);
+
+	float CellSize;
+
+	TSparseArray<FLight> Lights;
+
+	/** Handles of every light overlapping each cell */
+	TMap<FIntPoint, TArray<int32>> Cells;
+};
@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutLoadGenerator.h"
+#include "Blackout.h"
+#include "Engine/GameInstance.h"
+#include "Engine/GameViewportClient.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/Parse.h"
+
+const double FBlackoutLoadGenerator::JoinIntervalSeconds = 0.5;
+
+/** Reads -BlackoutLoadClients=, 0 if it isn't there */
+static int32 GetLoadClients()
+{
+	int32 players = 0;
+	FParse::Value(FCommandLine::Get(), TEXT("BlackoutLoadClients="), players);
+	return FMath::Max(0, players);
+}
+
+FBlackoutLoadGenerator& FBlackoutLoadGenerator::Get()
+{
+	static FBlackoutLoadGenerator instance;
+	return instance;
+}
+
+bool FBlackoutLoadGenerator::IsHeadless()
+{
+	static const bool headless = GetLoadClients() > 0;
+	return headless;
+}
+
+void FBlackoutLoadGenerator::StartFromCommandLine(UGameInstance* gameInstance)
+{
+	if (!IsHeadless() || endFrameHandle.IsValid()) {
+		return;
+	}
+	owner = gameInstance;
+	targetPlayers = GetLoadClients();
+	nextJoin = 0;
+	allJoined = false;
+
+	if (IConsoleVariable* autopilot = IConsoleManager::Get().FindConsoleVariable(TEXT("Blackout.Autopilot"))) {
+		autopilot->Set(1);
+	}
+	endFrameHandle = FCoreDelegates::OnEndFrame.AddRaw(this, &FBlackoutLoadGenerator::OnEndFrame);
+	UE_LOG(LogBlackout, Display, TEXT("Load generator: %d headless clients"), targetPlayers);
+}
+
+void FBlackoutLoadGenerator::Stop()
+{
+	FCoreDelegates::OnEndFrame.Remove(endFrameHandle);
+	endFrameHandle.Reset();
+}
+
+void FBlackoutLoadGenerator::OnEndFrame()
+{
+	UGameInstance* gameInstance = owner.Get();
+	UWorld* world = gameInstance ? gameInstance->GetWorld() : nullptr;
+	if (!world || world->GetNetMode() != NM_Client) {
+		return;
+	}
+
+	// Extra players join through the first one's connection, once it is in the game
+	const UNetDriver* driver = world->GetNetDriver();
+	if (!driver || !driver->ServerConnection || driver->ServerConnection->State != USOCK_Open || !gameInstance->GetFirstLocalPlayerController(world)) {
+		return;
+	}
+
+	const int32 players = gameInstance->GetNumLocalPlayers();
+	if (players >= targetPlayers) {
+		if (!allJoined) {
+			allJoined = true;
+			UE_LOG(LogBlackout, Display, TEXT("Load generator: all %d clients joined"), players);
+		}
+		return;
+	}
+
+	const double now = FPlatformTime::Seconds();
+	if (now < nextJoin) {
+		return;
+	}
+	nextJoin = now + JoinIntervalSeconds;
+
+	// Nothing is drawn, only the first player keeps the viewport
+	if (UGameViewportClient* viewport = gameInstance->GetGameViewportClient()) {
+		viewport->MaxSplitscreenPlayers = FMath::Max(viewport->MaxSplitscreenPlayers, targetPlayers);
+		viewport->SetForceDisableSplitscreen(true);
+	}
+
+	// On a client this asks the server to let the new player join
+	FString error;
+	if (!gameInstance->CreateLocalPlayer(-1, error, true)) {
+		UE_LOG(LogBlackout, Error, TEXT("Load generator: can't add client %d: %s"), players + 1, *error);
+		targetPlayers = players;
+	}
+}
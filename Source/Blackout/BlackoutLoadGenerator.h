@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UGameInstance;
+
+/**
+ * Headless load generating client. One process plays many lightweight clients against a server, so a single box can
+ * put a full lobby's worth of client traffic on a local dedicated server.
+ *
+ * With -BlackoutLoadClients=<n> the process connects to the server on its command line as usual, then adds a local
+ * player every JoinIntervalSeconds until it has n. Each extra player joins over the real network path as a child
+ * connection of the first, with its own controller and pawn on the server. The players share everything the process
+ * has loaded. Autopilot is turned on, so every pawn is driven through the real MoveForward, Turn and OnFire handlers.
+ *
+ * In this mode IsHeadless is true. HUD widgets, PersonalLight, first person meshes, footsteps, sounds and third
+ * person poses are skipped. Run with -nullrhi -nosound so nothing is rendered or mixed either. The server has to
+ * allow that many players per connection, see -AllowLoadClients in ABlackoutGameMode::InitGame.
+ * See Scripts/LoadTest.sh.
+ */
+class BLACKOUT_API FBlackoutLoadGenerator
+{
+public:
+	static FBlackoutLoadGenerator& Get();
+
+	/** True in a load generating client process */
+	static bool IsHeadless();
+
+	/** Starts adding players if asked to on the command line. Called once by UBlackoutGameInstance::Init. */
+	void StartFromCommandLine(UGameInstance* gameInstance);
+	void Stop();
+
+	/** Time between players joining, so the server sees a lobby fill up rather than a burst of joins */
+	static const double JoinIntervalSeconds;
+
+private:
+	void OnEndFrame();
+
+	TWeakObjectPtr<UGameInstance> owner;
+
+	/** Local players to end up with */
+	int32 targetPlayers = 0;
+
+	double nextJoin = 0;
+	bool allJoined = false;
+	FDelegateHandle endFrameHandle;
+};
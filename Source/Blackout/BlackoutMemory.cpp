@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutMemory.h"
+#include "Blackout.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_LLM_MEMORY_STAT(TEXT("Blackout Characters"), STAT_BlackoutCharactersLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("Blackout Projectiles"), STAT_BlackoutProjectilesLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("Blackout Powerups"), STAT_BlackoutPowerupsLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("Blackout UI"), STAT_BlackoutUILLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("Blackout Telemetry"), STAT_BlackoutTelemetryLLM, STATGROUP_LLMFULL);
+
+static FAutoConsoleCommandWithArgs MemorySnapshotCommand(
+	TEXT("Blackout.Memory.Snapshot"),
+	TEXT("Logs memory per Blackout LLM tag. Needs -LLM. Usage: Blackout.Memory.Snapshot [Label]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		BlackoutMemory::LogSnapshot(Args.Num() > 0 ? FString::Join(Args, TEXT(" ")) : TEXT("manual"));
+	}));
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+static const TCHAR* GetTagName(EBlackoutLLMTag tag)
+{
+	switch (tag) {
+	case EBlackoutLLMTag::Characters: return TEXT("BlackoutCharacters");
+	case EBlackoutLLMTag::Projectiles: return TEXT("BlackoutProjectiles");
+	case EBlackoutLLMTag::Powerups: return TEXT("BlackoutPowerups");
+	case EBlackoutLLMTag::UI: return TEXT("BlackoutUI");
+	case EBlackoutLLMTag::Telemetry: return TEXT("BlackoutTelemetry");
+	default: return TEXT("BlackoutUnknown");
+	}
+}
+
+static int32 ToLLMTag(EBlackoutLLMTag tag)
+{
+	return (int32)ELLMTag::ProjectTagStart + (int32)tag;
+}
+#endif
+
+void BlackoutMemory::RegisterTags()
+{
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+	FLowLevelMemTracker& tracker = FLowLevelMemTracker::Get();
+	tracker.RegisterProjectTag(ToLLMTag(EBlackoutLLMTag::Characters), GetTagName(EBlackoutLLMTag::Characters), GET_STATFNAME(STAT_BlackoutCharactersLLM), NAME_None);
+	tracker.RegisterProjectTag(ToLLMTag(EBlackoutLLMTag::Projectiles), GetTagName(EBlackoutLLMTag::Projectiles), GET_STATFNAME(STAT_BlackoutProjectilesLLM), NAME_None);
+	tracker.RegisterProjectTag(ToLLMTag(EBlackoutLLMTag::Powerups), GetTagName(EBlackoutLLMTag::Powerups), GET_STATFNAME(STAT_BlackoutPowerupsLLM), NAME_None);
+	tracker.RegisterProjectTag(ToLLMTag(EBlackoutLLMTag::UI), GetTagName(EBlackoutLLMTag::UI), GET_STATFNAME(STAT_BlackoutUILLM), NAME_None);
+	tracker.RegisterProjectTag(ToLLMTag(EBlackoutLLMTag::Telemetry), GetTagName(EBlackoutLLMTag::Telemetry), GET_STATFNAME(STAT_BlackoutTelemetryLLM), NAME_None);
+#endif
+}
+
+TMap<FString, int64> BlackoutMemory::GetTagAmounts()
+{
+	TMap<FString, int64> amounts;
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+	if (FLowLevelMemTracker::IsEnabled()) {
+		for (int32 i = 0; i < (int32)EBlackoutLLMTag::Count; i++) {
+			const EBlackoutLLMTag tag = (EBlackoutLLMTag)i;
+			amounts.Add(GetTagName(tag), FLowLevelMemTracker::Get().GetTagAmountForTracker(ELLMTracker::Default, (ELLMTag)ToLLMTag(tag)));
+		}
+	}
+#endif
+	return amounts;
+}
+
+void BlackoutMemory::LogSnapshot(const FString& label)
+{
+	const TMap<FString, int64> amounts = GetTagAmounts();
+	if (amounts.Num() == 0) {
+		UE_LOG(LogBlackout, Display, TEXT("Memory (%s): LLM is not enabled, run with -LLM"), *label);
+		return;
+	}
+	UE_LOG(LogBlackout, Display, TEXT("Memory (%s):"), *label);
+	for (const TPair<FString, int64>& pair : amounts) {
+		UE_LOG(LogBlackout, Display, TEXT("  %-24s %10.2f MB"), *pair.Key, pair.Value / (1024.0 * 1024.0));
+	}
+}
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+/**
+ * Low level memory tracker tags for Blackout's subsystems. Run with -LLM (and -LLMCSV for a CSV over time), then
+ * `stat LLMFULL` shows each under its own name instead of lumped into UObject and actor memory.
+ */
+enum class EBlackoutLLMTag : int32
+{
+	/** Characters and their first person meshes, camera and lights */
+	Characters,
+	/** Projectiles and their lights */
+	Projectiles,
+	Powerups,
+	/** HUD and UMG widgets */
+	UI,
+	/** Blackout's own instrumentation: fire traces, net accounting, hitch and perf test buffers */
+	Telemetry,
+
+	Count
+};
+
+/** Attributes allocations in the enclosing scope to a Blackout tag */
+#define BLACKOUT_LLM_SCOPE(Tag) LLM_SCOPE((ELLMTag)((int32)ELLMTag::ProjectTagStart + (int32)EBlackoutLLMTag::Tag))
+
+namespace BlackoutMemory
+{
+	/** Registers the tag names with the tracker. Called once at module startup. */
+	void RegisterTags();
+
+	/** Bytes currently allocated under every tag, by tag name. Empty if LLM is compiled out or not enabled. */
+	TMap<FString, int64> GetTagAmounts();
+
+	/** Logs every tag's current amount, labelled e.g. "match start" */
+	void LogSnapshot(const FString& label);
+}
@@ -0,0 +1,255 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutMetricsServer.h"
+#include "Blackout.h"
+#include "BlackoutBeaconHostObject.h"
+#include "BlackoutCharacterMovementComponent.h"
+#include "BlackoutMemory.h"
+#include "BlackoutPlayerState.h"
+#include "BlackoutProjectile.h"
+#include "BlackoutScheduler.h"
+#include "BlackoutServerGovernor.h"
+#include "BlackoutStats.h"
+#include "Common/TcpListener.h"
+#include "Engine/Engine.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/GameStateBase.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/Parse.h"
+#include "Powerup.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "UObject/UObjectArray.h"
+
+const double FBlackoutMetricsServer::PublishSeconds = 1.0;
+
+/** Appends one sample in the Prometheus text format. `labels` is e.g. `category="HUD"`, or empty. */
+static void AppendMetric(FString& out, const TCHAR* name, double value, const FString& labels = FString())
+{
+	if (labels.IsEmpty()) {
+		out += FString::Printf(TEXT("blackout_%s %.3f\n"), name, value);
+	}
+	else {
+		out += FString::Printf(TEXT("blackout_%s{%s} %.3f\n"), name, *labels, value);
+	}
+}
+
+FBlackoutMetricsServer& FBlackoutMetricsServer::Get()
+{
+	static FBlackoutMetricsServer instance;
+	return instance;
+}
+
+FBlackoutMetricsServer::~FBlackoutMetricsServer()
+{
+	Stop();
+}
+
+void FBlackoutMetricsServer::StartFromCommandLine()
+{
+	int32 port = 0;
+	if (FParse::Value(FCommandLine::Get(), TEXT("MetricsPort="), port) && port > 0) {
+		Start(port);
+	}
+}
+
+void FBlackoutMetricsServer::Start(int32 port)
+{
+	if (listener) {
+		return;
+	}
+	BLACKOUT_LLM_SCOPE(Telemetry);
+	frameMs.Init(0.f, WindowFrames);
+	busyMs.Init(0.f, WindowFrames);
+	nextFrame = 0;
+	deathSamples.Reset();
+	lastPublish = 0;
+
+	// Loopback only, the counters are for whoever is on the machine and nobody else
+	listener = MakeUnique<FTcpListener>(FIPv4Endpoint(FIPv4Address(127, 0, 0, 1), port), FTimespan::FromMilliseconds(100));
+	listener->OnConnectionAccepted().BindRaw(this, &FBlackoutMetricsServer::OnConnection);
+	endFrameHandle = FCoreDelegates::OnEndFrame.AddRaw(this, &FBlackoutMetricsServer::OnEndFrame);
+	UE_LOG(LogBlackout, Display, TEXT("Serving metrics on http://127.0.0.1:%d/metrics"), port);
+}
+
+void FBlackoutMetricsServer::Stop()
+{
+	if (!listener) {
+		return;
+	}
+	FCoreDelegates::OnEndFrame.Remove(endFrameHandle);
+	// Joins the listener thread, so no scrape is still reading a snapshot after this
+	listener.Reset();
+}
+
+void FBlackoutMetricsServer::OnEndFrame()
+{
+	frameMs[nextFrame] = FApp::GetDeltaTime() * 1000.0;
+	busyMs[nextFrame] = FMath::Max(0.0, FApp::GetDeltaTime() - FApp::GetIdleTime()) * 1000.0;
+	nextFrame = (nextFrame + 1) % WindowFrames;
+
+	const double now = FPlatformTime::Seconds();
+	if (now - lastPublish < PublishSeconds) {
+		return;
+	}
+	lastPublish = now;
+
+	if (UWorld* world = FindGameWorld()) {
+		BLACKOUT_LLM_SCOPE(Telemetry);
+		snapshots.Write() = Gather(world);
+		snapshots.SwapWriteBuffers();
+	}
+}
+
+FString FBlackoutMetricsServer::Gather(UWorld* world)
+{
+	FString out;
+	AppendMetric(out, TEXT("uptime_seconds"), FPlatformTime::Seconds() - GStartTime);
+	AppendMetric(out, TEXT("scrapes_total"), scrapes.GetValue());
+
+	// Players and score
+	const AGameStateBase* gameState = world->GetGameState();
+	int32 deaths = 0;
+	if (gameState) {
+		AppendMetric(out, TEXT("players"), gameState->PlayerArray.Num());
+		for (const APlayerState* playerState : gameState->PlayerArray) {
+			if (const ABlackoutPlayerState* blackoutState = Cast<ABlackoutPlayerState>(playerState)) {
+				deaths += blackoutState->Deaths;
+			}
+		}
+	}
+	AppendMetric(out, TEXT("deaths"), deaths);
+
+	// Deaths over the last minute. Players leaving take their deaths with them, which can't count as negative.
+	const double now = FPlatformTime::Seconds();
+	deathSamples.Emplace(now, deaths);
+	while (deathSamples.Num() > 1 && now - deathSamples[0].Key > 60.0) {
+		deathSamples.RemoveAt(0, 1, false);
+	}
+	const double minutes = (now - deathSamples[0].Key) / 60.0;
+	AppendMetric(out, TEXT("deaths_per_minute"), minutes > 0.0 ? FMath::Max(0, deaths - deathSamples[0].Value) / minutes : 0.0);
+
+	// Frame time over the last WindowFrames frames
+	TArray<float> sorted = frameMs;
+	sorted.Sort();
+	AppendMetric(out, TEXT("frame_ms"), BlackoutStats::Percentile(sorted, 50.f), TEXT("quantile=\"0.5\""));
+	AppendMetric(out, TEXT("frame_ms"), BlackoutStats::Percentile(sorted, 95.f), TEXT("quantile=\"0.95\""));
+	AppendMetric(out, TEXT("frame_ms"), BlackoutStats::Percentile(sorted, 99.f), TEXT("quantile=\"0.99\""));
+	sorted = busyMs;
+	sorted.Sort();
+	AppendMetric(out, TEXT("game_thread_ms"), BlackoutStats::Percentile(sorted, 50.f), TEXT("quantile=\"0.5\""));
+	AppendMetric(out, TEXT("game_thread_ms"), BlackoutStats::Percentile(sorted, 95.f), TEXT("quantile=\"0.95\""));
+	AppendMetric(out, TEXT("game_thread_ms"), BlackoutStats::Percentile(sorted, 99.f), TEXT("quantile=\"0.99\""));
+	AppendMetric(out, TEXT("client_moves_total"), UBlackoutCharacterMovementComponent::ServerMovesProcessed);
+	AppendMetric(out, TEXT("governor_tier"), (int32)ABlackoutServerGovernor::GetTier(world));
+
+	// Actors
+	int32 projectiles = 0;
+	for (TActorIterator<ABlackoutProjectile> it(world); it; ++it) {
+		projectiles++;
+	}
+	AppendMetric(out, TEXT("projectiles"), projectiles);
+
+	int32 powerupsAvailable = 0;
+	int32 powerupsRespawning = 0;
+	for (TActorIterator<APowerup> it(world); it; ++it) {
+		(it->GetVisible() ? powerupsAvailable : powerupsRespawning)++;
+	}
+	AppendMetric(out, TEXT("powerups"), powerupsAvailable, TEXT("state=\"available\""));
+	AppendMetric(out, TEXT("powerups"), powerupsRespawning, TEXT("state=\"respawning\""));
+
+	// Replication
+	if (UNetDriver* driver = world->GetNetDriver()) {
+		AppendMetric(out, TEXT("connections"), driver->ClientConnections.Num());
+		for (UNetConnection* connection : driver->ClientConnections) {
+			const FString labels = FString::Printf(TEXT("connection=\"%s\""), *connection->LowLevelGetRemoteAddress(true));
+			AppendMetric(out, TEXT("connection_out_bytes_per_second"), connection->OutBytesPerSecond, labels);
+			AppendMetric(out, TEXT("connection_in_bytes_per_second"), connection->InBytesPerSecond, labels);
+			AppendMetric(out, TEXT("connection_queued_bits"), connection->QueuedBits, labels);
+		}
+	}
+
+	// Queues and pools. Looked up rather than Get, which would spawn a scheduler just to report on it.
+	for (TActorIterator<ABlackoutScheduler> it(world); it; ++it) {
+		for (int32 i = 0; i < (int32)EBlackoutTimerCategory::Count; i++) {
+			const EBlackoutTimerCategory category = (EBlackoutTimerCategory)i;
+			AppendMetric(out, TEXT("timers_active"), it->GetWheel().GetStats(category).Active,
+				FString::Printf(TEXT("category=\"%s\""), FBlackoutTimerWheel::GetCategoryName(category)));
+		}
+	}
+	for (TActorIterator<ABlackoutBeaconHostObject> it(world); it; ++it) {
+		AppendMetric(out, TEXT("beacon_reservations"), it->GetReservationCount());
+	}
+	AppendMetric(out, TEXT("uobjects"), GUObjectArray.GetObjectArrayNumMinusAvailable());
+	AppendMetric(out, TEXT("used_physical_mb"), FPlatformMemory::GetStats().UsedPhysical / (1024.0 * 1024.0));
+	return out;
+}
+
+bool FBlackoutMetricsServer::OnConnection(FSocket* socket, const FIPv4Endpoint& endpoint)
+{
+	// Read the request line, anything but the metrics is a 404. Scrapers send their request right away.
+	FString path;
+	uint8 request[1024];
+	int32 received = 0;
+	if (socket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromMilliseconds(500))
+		&& socket->Recv(request, sizeof(request) - 1, received) && received > 0) {
+		request[received] = 0;
+		const FString line = FString(UTF8_TO_TCHAR((const ANSICHAR*)request));
+		TArray<FString> words;
+		line.ParseIntoArrayWS(words);
+		path = words.Num() > 1 ? words[1] : FString();
+	}
+
+	FString status = TEXT("200 OK");
+	FString body;
+	if (path == TEXT("/metrics") || path == TEXT("/")) {
+		scrapes.Increment();
+		snapshots.SwapReadBuffers();
+		body = snapshots.Read();
+		if (body.IsEmpty()) {
+			status = TEXT("503 Service Unavailable");
+			body = TEXT("# no snapshot yet\n");
+		}
+	}
+	else {
+		status = TEXT("404 Not Found");
+		body = TEXT("# only /metrics is served\n");
+	}
+
+	const FTCHARToUTF8 bodyUtf8(*body);
+	const FString header = FString::Printf(TEXT("HTTP/1.0 %s\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %d\r\nConnection: close\r\n\r\n"),
+		*status, bodyUtf8.Length());
+	const FTCHARToUTF8 headerUtf8(*header);
+
+	int32 sent = 0;
+	socket->Send((const uint8*)headerUtf8.Get(), headerUtf8.Length(), sent);
+	for (int32 offset = 0; offset < bodyUtf8.Length(); offset += sent) {
+		if (!socket->Send((const uint8*)bodyUtf8.Get() + offset, bodyUtf8.Length() - offset, sent) || sent <= 0) {
+			break;
+		}
+	}
+
+	socket->Close();
+	ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(socket);
+	return true;
+}
+
+UWorld* FBlackoutMetricsServer::FindGameWorld()
+{
+	if (!GEngine) {
+		return nullptr;
+	}
+	for (const FWorldContext& context : GEngine->GetWorldContexts()) {
+		if (context.WorldType == EWorldType::Game && context.World()) {
+			return context.World();
+		}
+	}
+	return nullptr;
+}
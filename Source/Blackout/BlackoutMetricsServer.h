@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/TripleBuffer.h"
+#include "HAL/ThreadSafeCounter.h"
+
+class FSocket;
+class FTcpListener;
+class UWorld;
+struct FIPv4Endpoint;
+
+/**
+ * Opt-in endpoint serving a running server's live counters over HTTP on loopback only: players, frame time
+ * percentiles, projectiles in flight, replication bytes per connection, powerup states, deaths per minute and
+ * timer, reservation and object counts. Start with -MetricsPort=<port>, then `curl http://127.0.0.1:<port>/metrics`.
+ * The body is in the Prometheus text format.
+ *
+ * The game thread gathers the counters once per PublishSeconds at the end of a frame and hands the text over
+ * through a triple buffer. Scrapes are answered on the listener's own thread from the latest snapshot, so they
+ * never wait for, or hold up, the game thread.
+ */
+class BLACKOUT_API FBlackoutMetricsServer
+{
+public:
+	static FBlackoutMetricsServer& Get();
+	~FBlackoutMetricsServer();
+
+	/** Starts listening if -MetricsPort= is on the command line. Called once by UBlackoutGameInstance::Init. */
+	void StartFromCommandLine();
+	void Start(int32 port);
+	void Stop();
+
+	/** How often the game thread publishes a new snapshot */
+	static const double PublishSeconds;
+
+private:
+	/** Frames kept for the frame time percentiles */
+	static const int32 WindowFrames = 300;
+
+	void OnEndFrame();
+
+	/** Gathers every counter of `world` into the text served to scrapes */
+	FString Gather(UWorld* world);
+
+	/** Listener thread: answers one request and closes the connection */
+	bool OnConnection(FSocket* socket, const FIPv4Endpoint& endpoint);
+
+	/** The world being served, the game world of a server or standalone game */
+	static UWorld* FindGameWorld();
+
+	TUniquePtr<FTcpListener> listener;
+
+	/** Written by the game thread, read by the listener thread */
+	TTripleBuffer<FString> snapshots;
+
+	TArray<float> frameMs;
+	TArray<float> busyMs;
+	int32 nextFrame = 0;
+
+	/** Total deaths at each publish over the last minute, for deaths per minute */
+	TArray<TPair<double, int32>> deathSamples;
+
+	double lastPublish = 0;
+	FDelegateHandle endFrameHandle;
+	FThreadSafeCounter scrapes;
+};
@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutNetDriver.h"
+#include "Blackout.h"
+#include "BlackoutMemory.h"
+#include "Engine/NetConnection.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+static FAutoConsoleCommandWithWorld NetReportCommand(
+	TEXT("Blackout.Net.Report"),
+	TEXT("Logs outgoing bandwidth by connection, actor class and RPC, compared to budgets"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UBlackoutNetDriver* driver = World ? Cast<UBlackoutNetDriver>(World->GetNetDriver()) : nullptr) {
+			driver->ReportUsage(false);
+		}
+		else {
+			UE_LOG(LogBlackout, Warning, TEXT("Blackout.Net.Report needs a UBlackoutNetDriver"));
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld NetResetCommand(
+	TEXT("Blackout.Net.Reset"),
+	TEXT("Restarts bandwidth measurement"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UBlackoutNetDriver* driver = World ? Cast<UBlackoutNetDriver>(World->GetNetDriver()) : nullptr) {
+			driver->ResetUsage();
+		}
+	}));
+
+UBlackoutNetDriver::UBlackoutNetDriver(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	MaxBytesPerSecondPerConnection = 0.f;
+	FParse::Value(FCommandLine::Get(), TEXT("NetBudgetTest="), budgetTestSeconds);
+}
+
+void UBlackoutNetDriver::ProcessRemoteFunction(AActor* Actor, UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack, UObject* SubObject)
+{
+	// Multicasts can recurse into other drivers' RPCs, so restore rather than clear
+	const FName previousRpc = currentRpc;
+	currentRpc = Function->GetFName();
+	Super::ProcessRemoteFunction(Actor, Function, Parameters, OutParms, Stack, SubObject);
+	currentRpc = previousRpc;
+}
+
+void UBlackoutNetDriver::TrackBunch(UNetConnection* connection, const AActor* actor, int64 bits)
+{
+	BLACKOUT_LLM_SCOPE(Telemetry);
+	if (currentRpc != NAME_None) {
+		bitsByRpc.FindOrAdd(currentRpc) += bits;
+	}
+	else {
+		bitsByClass.FindOrAdd(actor ? actor->GetClass()->GetFName() : NAME_None) += bits;
+	}
+	usageByConnection.FindOrAdd(connection->LowLevelGetRemoteAddress(true)).PayloadBits += bits;
+}
+
+void UBlackoutNetDriver::TickFlush(float DeltaSeconds)
+{
+	Super::TickFlush(DeltaSeconds);
+
+	TArray<UNetConnection*> connections = ClientConnections;
+	if (ServerConnection) {
+		connections.Add(ServerConnection);
+	}
+	if (connections.Num() == 0) {
+		return;
+	}
+
+	measuredSeconds += DeltaSeconds;
+	for (UNetConnection* connection : connections) {
+		// OutBytesPerSecond is the engine's own count, including packet headers and acks
+		usageByConnection.FindOrAdd(connection->LowLevelGetRemoteAddress(true)).WireBytes += connection->OutBytesPerSecond * DeltaSeconds;
+	}
+
+	if (budgetTestSeconds > 0.f && measuredSeconds >= budgetTestSeconds) {
+		budgetTestSeconds = 0.f;
+		const bool passed = ReportUsage(true);
+		UE_LOG(LogBlackout, Display, TEXT("Net budget test %s"), passed ? TEXT("passed") : TEXT("FAILED"));
+		FPlatformMisc::RequestExitWithStatus(false, passed ? 0 : 1);
+	}
+}
+
+void UBlackoutNetDriver::ResetUsage()
+{
+	measuredSeconds = 0;
+	bitsByClass.Reset();
+	bitsByRpc.Reset();
+	usageByConnection.Reset();
+}
+
+/** Looks up a budget by name, 0 if there is none */
+static float FindBudget(const TArray<FBlackoutNetBudget>& budgets, FName name)
+{
+	const FBlackoutNetBudget* budget = budgets.FindByPredicate([name](const FBlackoutNetBudget& b) { return b.Name == name; });
+	return budget ? budget->BytesPerSecond : 0.f;
+}
+
+bool UBlackoutNetDriver::ReportUsage(bool writeCsv)
+{
+	const double seconds = FMath::Max(measuredSeconds, 0.001);
+	const int32 numConnections = FMath::Max(1, usageByConnection.Num());
+	bool passed = true;
+
+	FString csv = TEXT("Kind,Name,BytesPerSecondPerConnection,Budget,Passed\n");
+	auto check = [&](const TCHAR* kind, const FString& name, double bytesPerSecond, float budget) {
+		const bool ok = budget <= 0.f || bytesPerSecond <= budget;
+		passed &= ok;
+		csv += FString::Printf(TEXT("%s,%s,%.1f,%.1f,%d\n"), kind, *name, bytesPerSecond, budget, ok ? 1 : 0);
+		UE_LOG(LogBlackout, Display, TEXT("  %-10s %-32s %10.1f B/s%s"), kind, *name, bytesPerSecond,
+			ok ? TEXT("") : *FString::Printf(TEXT("  OVER BUDGET (%.1f)"), budget));
+	};
+
+	UE_LOG(LogBlackout, Display, TEXT("Net usage over %.1f s, %d connections:"), seconds, usageByConnection.Num());
+	for (const TPair<FString, FConnectionUsage>& pair : usageByConnection) {
+		check(TEXT("Connection"), pair.Key, pair.Value.WireBytes / seconds, MaxBytesPerSecondPerConnection);
+	}
+
+	// Classes and RPCs are summed over every connection, report them per connection
+	bitsByClass.ValueSort(TGreater<int64>());
+	for (const TPair<FName, int64>& pair : bitsByClass) {
+		check(TEXT("Class"), pair.Key.ToString(), pair.Value / 8.0 / seconds / numConnections, FindBudget(ClassBudgets, pair.Key));
+	}
+	bitsByRpc.ValueSort(TGreater<int64>());
+	for (const TPair<FName, int64>& pair : bitsByRpc) {
+		check(TEXT("RPC"), pair.Key.ToString(), pair.Value / 8.0 / seconds / numConnections, FindBudget(RpcBudgets, pair.Key));
+	}
+
+	if (writeCsv) {
+		const FString path = FPaths::Combine(FPaths::ProfilingDir(), TEXT("NetBudget.csv"));
+		FFileHelper::SaveStringToFile(csv, *path);
+		UE_LOG(LogBlackout, Display, TEXT("Wrote %s"), *path);
+	}
+	return passed;
+}
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IpNetDriver.h"
+#include "BlackoutNetDriver.generated.h"
+
+/** Maximum outgoing bandwidth for one actor class or RPC, per client connection */
+USTRUCT()
+struct FBlackoutNetBudget
+{
+	GENERATED_BODY()
+
+	/** Actor class name (without prefix, e.g. BlackoutProjectile) or RPC name (e.g. DoFireAnimation) */
+	UPROPERTY(Config)
+	FName Name;
+
+	UPROPERTY(Config)
+	float BytesPerSecond = 0.f;
+};
+
+/**
+ * Game net driver that attributes every outgoing actor bunch to the actor's class, or to the RPC being sent,
+ * so replication cost can be measured and held to budgets.
+ *
+ * Bandwidth regression test: start a server with -NetBudgetTest=<seconds>, connect clients with
+ * `Blackout.Autopilot 1` (see Scripts/NetBudgetTest.sh). Once the first client has been connected for that long
+ * the server writes Saved/Profiling/NetBudget.csv and exits with 1 if any budget was exceeded, 0 otherwise.
+ * `Blackout.Net.Report` logs the same numbers at any time.
+ */
+UCLASS(transient, config=Engine)
+class BLACKOUT_API UBlackoutNetDriver : public UIpNetDriver
+{
+	GENERATED_BODY()
+
+public:
+	UBlackoutNetDriver(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+	void ProcessRemoteFunction(AActor* Actor, UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack, UObject* SubObject = nullptr) override;
+	void TickFlush(float DeltaSeconds) override;
+
+	/** Called by UBlackoutActorChannel for every bunch it sends */
+	void TrackBunch(UNetConnection* connection, const AActor* actor, int64 bits);
+
+	/** Logs usage against budgets. Returns false if any budget is exceeded. */
+	bool ReportUsage(bool writeCsv);
+
+	/** Forgets everything measured so far */
+	void ResetUsage();
+
+	/** Budget for the average outgoing bytes per second of each client connection, 0 for no limit */
+	UPROPERTY(Config)
+	float MaxBytesPerSecondPerConnection;
+
+	/** Budgets per actor class, for property replication */
+	UPROPERTY(Config)
+	TArray<FBlackoutNetBudget> ClassBudgets;
+
+	/** Budgets per RPC */
+	UPROPERTY(Config)
+	TArray<FBlackoutNetBudget> RpcBudgets;
+
+private:
+	struct FConnectionUsage
+	{
+		int64 PayloadBits = 0;
+		double WireBytes = 0;
+	};
+
+	/** RPC currently being sent, bunches sent meanwhile are charged to it */
+	FName currentRpc;
+
+	/** Seconds spent measuring, only counted while clients are connected */
+	double measuredSeconds = 0;
+
+	/** Length of the bandwidth regression test, 0 if not running one */
+	float budgetTestSeconds = 0.f;
+
+	TMap<FName, int64> bitsByClass;
+	TMap<FName, int64> bitsByRpc;
+	TMap<FString, FConnectionUsage> usageByConnection;
+};
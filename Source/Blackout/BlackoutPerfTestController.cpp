@@ -0,0 +1,206 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutPerfTestController.h"
+#include "Blackout.h"
+#include "BlackoutStats.h"
+#include "BlackoutMemory.h"
+#include "Dom/JsonObject.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "HAL/PlatformMemory.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+ABlackoutPerfTestController::ABlackoutPerfTestController()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	// Sample after everything else has ticked
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+	bReplicates = false;
+
+	WarmupSeconds = 15.f;
+}
+
+void ABlackoutPerfTestController::StartIfRequested(UWorld* world)
+{
+	float seconds = 0.f;
+	if (!world || world->GetNetMode() == NM_Client || !FParse::Value(FCommandLine::Get(), TEXT("BlackoutPerfTest="), seconds) || seconds <= 0.f) {
+		return;
+	}
+
+	ABlackoutPerfTestController* controller = world->SpawnActor<ABlackoutPerfTestController>();
+	controller->measureSeconds = seconds;
+	controller->updateBaseline = FParse::Param(FCommandLine::Get(), TEXT("PerfTestUpdateBaseline"));
+	FParse::Value(FCommandLine::Get(), TEXT("PerfTestWarmup="), controller->WarmupSeconds);
+	UE_LOG(LogBlackout, Display, TEXT("Perf test: measuring %.0f s after %.0f s warmup, once a client joins"), seconds, controller->WarmupSeconds);
+}
+
+void ABlackoutPerfTestController::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	UNetDriver* driver = GetWorld()->GetNetDriver();
+	if (!driver || driver->ClientConnections.Num() == 0) {
+		return;
+	}
+
+	elapsedSeconds += DeltaSeconds;
+	if (elapsedSeconds < WarmupSeconds) {
+		return;
+	}
+	if (memorySnapshots.Num() == 0) {
+		SnapshotMemory(TEXT("Start"));
+	}
+	else if (memorySnapshots.Num() == 1 && elapsedSeconds >= WarmupSeconds + measureSeconds * 0.5f) {
+		SnapshotMemory(TEXT("Mid"));
+	}
+	Sample(DeltaSeconds);
+
+	if (elapsedSeconds >= WarmupSeconds + measureSeconds) {
+		Finish();
+	}
+}
+
+void ABlackoutPerfTestController::Sample(float DeltaSeconds)
+{
+	BLACKOUT_LLM_SCOPE(Telemetry);
+	samples.FindOrAdd(TEXT("FrameMs")).Add(FApp::GetDeltaTime() * 1000.0);
+	// Time the frame spent working rather than waiting for the next tick
+	samples.FindOrAdd(TEXT("GameThreadMs")).Add(FMath::Max(0.0, FApp::GetDeltaTime() - FApp::GetIdleTime()) * 1000.0);
+	samples.FindOrAdd(TEXT("UsedPhysicalMB")).Add(FPlatformMemory::GetStats().UsedPhysical / (1024.0 * 1024.0));
+
+	const TArray<UNetConnection*>& connections = GetWorld()->GetNetDriver()->ClientConnections;
+	int64 outBytes = 0;
+	int64 inBytes = 0;
+	for (const UNetConnection* connection : connections) {
+		outBytes += connection->OutBytesPerSecond;
+		inBytes += connection->InBytesPerSecond;
+	}
+	samples.FindOrAdd(TEXT("OutBytesPerSecondPerConnection")).Add(float(outBytes) / connections.Num());
+	samples.FindOrAdd(TEXT("InBytesPerSecondPerConnection")).Add(float(inBytes) / connections.Num());
+}
+
+void ABlackoutPerfTestController::SnapshotMemory(const FString& phase)
+{
+	BlackoutMemory::LogSnapshot(FString::Printf(TEXT("perf test %s"), *phase));
+	memorySnapshots.Add(phase, BlackoutMemory::GetTagAmounts());
+}
+
+TMap<FString, double> ABlackoutPerfTestController::Summarize()
+{
+	TMap<FString, double> summary;
+	for (TPair<FString, TArray<float>>& pair : samples) {
+		pair.Value.Sort();
+		summary.Add(pair.Key + TEXT(".p50"), BlackoutStats::Percentile(pair.Value, 50.f));
+		summary.Add(pair.Key + TEXT(".p95"), BlackoutStats::Percentile(pair.Value, 95.f));
+		summary.Add(pair.Key + TEXT(".p99"), BlackoutStats::Percentile(pair.Value, 99.f));
+		summary.Add(pair.Key + TEXT(".max"), BlackoutStats::Percentile(pair.Value, 100.f));
+	}
+
+	for (const TPair<FString, TMap<FString, int64>>& snapshot : memorySnapshots) {
+		for (const TPair<FString, int64>& tag : snapshot.Value) {
+			summary.Add(FString::Printf(TEXT("LLM.%s.%sMB"), *tag.Key, *snapshot.Key), tag.Value / (1024.0 * 1024.0));
+		}
+	}
+	const TMap<FString, int64>* start = memorySnapshots.Find(TEXT("Start"));
+	const TMap<FString, int64>* end = memorySnapshots.Find(TEXT("End"));
+	if (start && end) {
+		const int32 clients = FMath::Max(1, GetWorld()->GetNetDriver()->ClientConnections.Num());
+		for (const TPair<FString, int64>& tag : *end) {
+			const int64 growth = tag.Value - start->FindRef(tag.Key);
+			summary.Add(FString::Printf(TEXT("LLM.%s.GrowthPerClientKB"), *tag.Key), growth / 1024.0 / clients);
+		}
+	}
+	return summary;
+}
+
+/** True if the baseline at `path` is a placeholder, `"Pending": true`, waiting for its first run */
+static bool IsPendingBaseline(const FString& path)
+{
+	FString text;
+	TSharedPtr<FJsonObject> baseline;
+	bool pending = false;
+	return FFileHelper::LoadFileToString(text, *path)
+		&& FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(text), baseline) && baseline.IsValid()
+		&& baseline->TryGetBoolField(TEXT("Pending"), pending) && pending;
+}
+
+bool ABlackoutPerfTestController::CheckGates(const TMap<FString, double>& summary, const FString& baselinePath) const
+{
+	FString baselineText;
+	TSharedPtr<FJsonObject> baseline;
+	if (!FFileHelper::LoadFileToString(baselineText, *baselinePath)
+		|| !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(baselineText), baseline) || !baseline.IsValid()) {
+		UE_LOG(LogBlackout, Error, TEXT("Perf test: no baseline at %s, failing. Run with -PerfTestUpdateBaseline to create one."), *baselinePath);
+		return false;
+	}
+
+	bool passed = true;
+	for (const FBlackoutPerfGate& gate : Gates) {
+		const double* current = summary.Find(gate.Metric);
+		double reference = 0.0;
+		// A gate that can't be checked fails, or a renamed metric would quietly stop being gated
+		if (!current || !baseline->TryGetNumberField(gate.Metric, reference)) {
+			UE_LOG(LogBlackout, Error, TEXT("  %-40s missing from the %s  FAILED"), *gate.Metric, current ? TEXT("baseline") : TEXT("run"));
+			passed = false;
+			continue;
+		}
+
+		const double limit = reference * (1.0 + gate.MaxRegressionPercent / 100.0);
+		const bool ok = *current <= limit;
+		passed &= ok;
+		UE_LOG(LogBlackout, Display, TEXT("  %-40s %10.2f  baseline %10.2f  limit %10.2f%s"),
+			*gate.Metric, *current, reference, limit, ok ? TEXT("") : TEXT("  REGRESSED"));
+	}
+	return passed;
+}
+
+void ABlackoutPerfTestController::Finish()
+{
+	SetActorTickEnabled(false);
+	SnapshotMemory(TEXT("End"));
+
+	const FString mapName = UGameplayStatics::GetCurrentLevelName(this, true);
+	const TMap<FString, double> summary = Summarize();
+
+	TSharedRef<FJsonObject> json = MakeShared<FJsonObject>();
+	json->SetStringField(TEXT("Map"), mapName);
+	json->SetNumberField(TEXT("Seconds"), measureSeconds);
+	json->SetNumberField(TEXT("Clients"), GetWorld()->GetNetDriver()->ClientConnections.Num());
+	for (const TPair<FString, double>& pair : summary) {
+		json->SetNumberField(pair.Key, pair.Value);
+	}
+	FString text;
+	FJsonSerializer::Serialize(json, TJsonWriterFactory<>::Create(&text));
+
+	const FString resultPath = FPaths::Combine(FPaths::ProfilingDir(), FString::Printf(TEXT("PerfTest_%s.json"), *mapName));
+	const FString baselinePath = FPaths::Combine(FPaths::ProjectDir(), TEXT("Perf"), FString::Printf(TEXT("Baseline_%s.json"), *mapName));
+	FFileHelper::SaveStringToFile(text, *resultPath);
+	UE_LOG(LogBlackout, Display, TEXT("Perf test: wrote %s"), *resultPath);
+
+	bool passed = true;
+	if (updateBaseline) {
+		FFileHelper::SaveStringToFile(text, *baselinePath);
+		UE_LOG(LogBlackout, Display, TEXT("Perf test: stored as the new baseline, %s"), *baselinePath);
+	}
+	else if (IsPendingBaseline(baselinePath)) {
+		// Nothing to compare against yet. The first run on the reference machine fills it in, and gates from then on.
+		FFileHelper::SaveStringToFile(text, *baselinePath);
+		UE_LOG(LogBlackout, Warning, TEXT("Perf test: %s was pending, stored this run in it. Commit it to start gating %s."), *baselinePath, *mapName);
+	}
+	else {
+		passed = CheckGates(summary, baselinePath);
+	}
+
+	UE_LOG(LogBlackout, Display, TEXT("Perf test %s"), passed ? TEXT("passed") : TEXT("FAILED"));
+	FPlatformMisc::RequestExitWithStatus(false, passed ? 0 : 1);
+}
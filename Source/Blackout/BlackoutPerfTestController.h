@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "BlackoutPerfTestController.generated.h"
+
+/** Regression gate on one summary metric, e.g. FrameMs.p95 */
+USTRUCT()
+struct FBlackoutPerfGate
+{
+	GENERATED_BODY()
+
+	/** Summary key, "<Metric>.<p50|p95|p99|max>" */
+	UPROPERTY(Config)
+	FString Metric;
+
+	/** How far above the baseline the metric may go, in percent */
+	UPROPERTY(Config)
+	float MaxRegressionPercent = 10.f;
+};
+
+/**
+ * Full match performance test, run on a dedicated server. Once the first client connects and the warmup has
+ * passed, it samples server frame time, game thread busy time, memory and per-connection bandwidth every frame
+ * for a fixed time. Then it writes a JSON summary of percentiles, compares it against the stored baseline for the
+ * map using Gates, and exits with 0 if nothing regressed and 1 otherwise. A missing baseline, or a gated metric
+ * missing from the run or the baseline, is a failure too. A baseline that only says `"Pending": true` is replaced
+ * by the run, which passes, so a new map's first run on the reference machine creates its baseline.
+ *
+ * Command line (server):
+ *   -BlackoutPerfTest=<seconds>    measure for this long, required
+ *   -PerfTestWarmup=<seconds>      ignore this long after the first client joins, default WarmupSeconds
+ *   -PerfTestUpdateBaseline        store this run as the new baseline instead of comparing
+ *
+ * With -LLM, memory per Blackout LLM tag is also snapshotted at the start, middle and end of the measurement and
+ * added to the summary, with its growth per client.
+ *
+ * Results go to Saved/Profiling/PerfTest_<Map>.json, baselines live in Perf/Baseline_<Map>.json.
+ * Scripts/PerfTest.sh runs Zap and Maze with autopilot clients.
+ */
+UCLASS(config=Game)
+class BLACKOUT_API ABlackoutPerfTestController : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	ABlackoutPerfTestController();
+
+	/** Spawns a controller if the command line asks for a perf test. Server only. */
+	static void StartIfRequested(UWorld* world);
+
+	void Tick(float DeltaSeconds) override;
+
+	/** Seconds ignored after the first client joins, while everything loads in and settles */
+	UPROPERTY(Config)
+	float WarmupSeconds;
+
+	UPROPERTY(Config)
+	TArray<FBlackoutPerfGate> Gates;
+
+private:
+	/** Samples one frame */
+	void Sample(float DeltaSeconds);
+
+	/** Writes the summary, checks the gates and exits */
+	void Finish();
+
+	/** Percentiles of every metric, keyed "<Metric>.<percentile>" */
+	TMap<FString, double> Summarize();
+
+	/** Logs and keeps memory per Blackout LLM tag for one phase of the match */
+	void SnapshotMemory(const FString& phase);
+
+	/** Checks the summary against the baseline. Returns false if any gate failed. */
+	bool CheckGates(const TMap<FString, double>& summary, const FString& baselinePath) const;
+
+	float measureSeconds = 0.f;
+	float elapsedSeconds = 0.f;
+	bool updateBaseline = false;
+
+	TMap<FString, TArray<float>> samples;
+
+	/** Bytes per LLM tag, by phase */
+	TMap<FString, TMap<FString, int64>> memorySnapshots;
+};
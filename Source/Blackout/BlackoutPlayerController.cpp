@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutPlayerController.h"
+#include "BlackoutCharacter.h"
+#include "BlackoutGameInstance.h"
+#include "BlackoutHUD.h"
+#include "BlackoutInputRecorder.h"
+#include "Blackout.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/IConsoleManager.h"
+#include "TimerManager.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Dropped fire and jump RPCs"), STAT_DroppedRpcs, STATGROUP_Blackout);
+
+static FAutoConsoleCommandWithWorld RpcDropsCommand(
+	TEXT("Blackout.Net.RpcDrops"),
+	TEXT("Server: logs how many fire and jump RPCs each connection has had dropped by rate limiting"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (!World) {
+			return;
+		}
+		for (FConstPlayerControllerIterator it = World->GetPlayerControllerIterator(); it; ++it) {
+			if (const ABlackoutPlayerController* playerController = Cast<ABlackoutPlayerController>(it->Get())) {
+				UE_LOG(LogBlackout, Display, TEXT("  %-32s fire %6d  jump %6d"),
+					playerController->PlayerState ? *playerController->PlayerState->GetPlayerName() : TEXT("?"),
+					playerController->GetFireLimiter().Dropped, playerController->GetJumpLimiter().Dropped);
+			}
+		}
+	}));
+
+ABlackoutPlayerController::ABlackoutPlayerController()
+{
+	FireBurst = 2.f;
+	JumpsPerSecond = 3.f;
+	JumpBurst = 2.f;
+	MaxDebtBeforeKick = 50.f;
+}
+
+bool ABlackoutPlayerController::ConsumeFireToken(float cooldown)
+{
+	if (FireLimiter.TryConsume(GetWorld()->GetRealTimeSeconds(), 1.f / FMath::Max(cooldown, KINDA_SMALL_NUMBER), FireBurst)) {
+		return true;
+	}
+	INC_DWORD_STAT(STAT_DroppedRpcs);
+	return false;
+}
+
+bool ABlackoutPlayerController::ConsumeJumpToken()
+{
+	// Mashing jump is normal play, dropped jumps never count towards a kick
+	if (JumpLimiter.TryConsume(GetWorld()->GetRealTimeSeconds(), JumpsPerSecond, JumpBurst, false)) {
+		return true;
+	}
+	INC_DWORD_STAT(STAT_DroppedRpcs);
+	return false;
+}
+
+bool ABlackoutPlayerController::IsFloodingRpcs() const
+{
+	return FireLimiter.IsFlooding(MaxDebtBeforeKick);
+}
+
+void ABlackoutPlayerController::PlayerTick(float DeltaTime)
+{
+	// Replayed input goes in just before the input stack would call the pawn, so it lands on the same frame
+	FBlackoutInputRecorder::Get().BeginFrame(this);
+	Super::PlayerTick(DeltaTime);
+	FBlackoutInputRecorder::Get().EndFrame(this, DeltaTime);
+}
+
+void ABlackoutPlayerController::PreClientTravel(const FString& PendingURL, ETravelType TravelType, bool bIsSeamlessTravel)
+{
+	Super::PreClientTravel(PendingURL, TravelType, bIsSeamlessTravel);
+
+	// Servers time the whole transition themselves, from RotateMap or ReloadMatch to StartPlay
+	if (GetNetMode() == NM_Client) {
+		if (UBlackoutGameInstance* gameInstance = GetGameInstance<UBlackoutGameInstance>()) {
+			gameInstance->BeginRoundTransition(bIsSeamlessTravel ? TEXT("seamless travel") : TEXT("travel"));
+		}
+	}
+}
+
+void ABlackoutPlayerController::AcknowledgePossession(APawn* P)
+{
+	Super::AcknowledgePossession(P);
+
+	if (GetNetMode() == NM_Client && P) {
+		if (UBlackoutGameInstance* gameInstance = GetGameInstance<UBlackoutGameInstance>()) {
+			gameInstance->EndRoundTransition();
+		}
+	}
+}
+
+void ABlackoutPlayerController::ClientResetMatch_Implementation()
+{
+	// Timed like a travel, from hearing about the new round to the first frame of it
+	if (GetNetMode() == NM_Client) {
+		if (UBlackoutGameInstance* gameInstance = GetGameInstance<UBlackoutGameInstance>()) {
+			gameInstance->BeginRoundTransition(TEXT("reset"));
+			GetWorldTimerManager().SetTimerForNextTick(FTimerDelegate::CreateUObject(gameInstance, &UBlackoutGameInstance::EndRoundTransition));
+		}
+	}
+
+	ABlackoutHUD* hud = Cast<ABlackoutHUD>(GetHUD());
+	if (!hud) {
+		return;
+	}
+
+	// Unpause through the pawn so its input flag stays in step with the menu
+	ABlackoutCharacter* character = Cast<ABlackoutCharacter>(GetPawn());
+	if (hud->IsPaused() && character) {
+		character->Pause();
+	}
+	hud->ResetHUD();
+}
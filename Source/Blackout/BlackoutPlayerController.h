@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PlayerController.h"
+#include "BlackoutRateLimiter.h"
+#include "BlackoutPlayerController.generated.h"
+
+/**
+ * Player controller for Blackout. Carries the server to client messages that are about the player rather than
+ * their pawn, and rate limits the gameplay RPCs of this player's connection.
+ */
+UCLASS(config=Game)
+class BLACKOUT_API ABlackoutPlayerController : public APlayerController
+{
+	GENERATED_BODY()
+
+public:
+	ABlackoutPlayerController();
+
+	/** The match was reset in place, put the HUD back to how it is at the start of a match */
+	UFUNCTION(Client, Reliable)
+	void ClientResetMatch();
+
+	/** Server: returns false if a fire RPC should be dropped. `cooldown` is the pawn's time between shots. */
+	bool ConsumeFireToken(float cooldown);
+
+	/** Server: returns false if a jump RPC should be dropped */
+	bool ConsumeJumpToken();
+
+	/** Server: true if this connection is flooding fire RPCs and should be disconnected. Jumps are only dropped. */
+	bool IsFloodingRpcs() const;
+
+	void PlayerTick(float DeltaTime) override;
+
+	/** Client: the server is moving to another map, time it until we are playing again */
+	void PreClientTravel(const FString& PendingURL, ETravelType TravelType, bool bIsSeamlessTravel) override;
+
+	/** Client: possessing a pawn is the first playable frame after travel */
+	void AcknowledgePossession(APawn* P) override;
+
+	FORCEINLINE const FBlackoutRateLimiter& GetFireLimiter() const { return FireLimiter; }
+	FORCEINLINE const FBlackoutRateLimiter& GetJumpLimiter() const { return JumpLimiter; }
+
+	/** Shots that may arrive back to back, to absorb jitter. The long run rate is still one per cooldown. */
+	UPROPERTY(Config, EditAnywhere, Category = "RPC limits")
+	float FireBurst;
+
+	UPROPERTY(Config, EditAnywhere, Category = "RPC limits")
+	float JumpsPerSecond;
+
+	UPROPERTY(Config, EditAnywhere, Category = "RPC limits")
+	float JumpBurst;
+
+	/** Dropped fire calls a client may owe before it is kicked for flooding */
+	UPROPERTY(Config, EditAnywhere, Category = "RPC limits")
+	float MaxDebtBeforeKick;
+
+private:
+	FBlackoutRateLimiter FireLimiter;
+	FBlackoutRateLimiter JumpLimiter;
+};
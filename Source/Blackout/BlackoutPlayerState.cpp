@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutPlayerState.h"
+#include "Net/UnrealNetwork.h"
+
+float ABlackoutPlayerState::GetAccuracy() const
+{
+	return ShotsFired > 0 ? float(ShotsHit) / float(ShotsFired) : 0.f;
+}
+
+void ABlackoutPlayerState::CopyProperties(APlayerState* PlayerState)
+{
+	// Keeps the scoreboard across seamless travel and reconnects
+	Super::CopyProperties(PlayerState);
+	if (ABlackoutPlayerState* other = Cast<ABlackoutPlayerState>(PlayerState)) {
+		other->Kills = Kills;
+		other->Deaths = Deaths;
+		other->ShotsFired = ShotsFired;
+		other->ShotsHit = ShotsHit;
+	}
+}
+
+void ABlackoutPlayerState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// Only changed counters are sent, at the player state's low NetUpdateFrequency
+	DOREPLIFETIME(ABlackoutPlayerState, Kills);
+	DOREPLIFETIME(ABlackoutPlayerState, Deaths);
+	DOREPLIFETIME(ABlackoutPlayerState, ShotsFired);
+	DOREPLIFETIME(ABlackoutPlayerState, ShotsHit);
+}
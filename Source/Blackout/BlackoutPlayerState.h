@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PlayerState.h"
+#include "BlackoutPlayerState.generated.h"
+
+/** Scoreboard entry for one player. Counters are only changed on the server. */
+UCLASS()
+class BLACKOUT_API ABlackoutPlayerState : public APlayerState
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(Replicated, BlueprintReadOnly, Category = "Score")
+	int32 Kills = 0;
+
+	UPROPERTY(Replicated, BlueprintReadOnly, Category = "Score")
+	int32 Deaths = 0;
+
+	/** Projectiles spawned */
+	UPROPERTY(Replicated, BlueprintReadOnly, Category = "Score")
+	int32 ShotsFired = 0;
+
+	/** Projectiles that hit another player */
+	UPROPERTY(Replicated, BlueprintReadOnly, Category = "Score")
+	int32 ShotsHit = 0;
+
+	/**
+	 * Arena this player was assigned to by ABlackoutArenaGameMode, INDEX_NONE if none. Server only. Relevancy checks
+	 * resolve the viewer's arena from this, so it holds whether or not the player currently has a pawn.
+	 */
+	UPROPERTY(VisibleInstanceOnly, Category = "Arena")
+	int32 ArenaIndex = INDEX_NONE;
+
+	/** Fraction of shots that hit, 0 before the first shot */
+	UFUNCTION(BlueprintPure, Category = "Score")
+	float GetAccuracy() const;
+
+	void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+protected:
+	void CopyProperties(APlayerState* PlayerState) override;
+};
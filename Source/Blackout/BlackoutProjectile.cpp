@@ -5,10 +5,18 @@
 #include "Components/SphereComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "BlackoutCharacter.h"
+#include "BlackoutArena.h"
+#include "BlackoutGameMode.h"
+#include "BlackoutFireTrace.h"
+#include "BlackoutPlayerState.h"
+#include "BlackoutMemory.h"
+#include "BlackoutSplitscreen.h"
+#include "Net/UnrealNetwork.h"
 
 
 ABlackoutProjectile::ABlackoutProjectile()
 {
+	BLACKOUT_LLM_SCOPE(Projectiles);
 	// Use a sphere as a simple collision representation
 	CollisionComp = CreateDefaultSubobject<USphereComponent>(TEXT("SphereComp"));
 	CollisionComp->InitSphereRadius(5.0f);
@@ -44,6 +52,108 @@ ABlackoutProjectile::ABlackoutProjectile()
 
 	// Die after 3 seconds by default
 	InitialLifeSpan = 1.0f;
+
+	// Clients simulate the flight themselves and smooth corrections, updates mostly carry bounces.
+	// The governor lowers this further in Minimal.
+	NetUpdateFrequency = 30.f;
+
+	// Only clients tick, to smooth replicated movement
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+}
+
+void ABlackoutProjectile::BeginPlay()
+{
+	BLACKOUT_LLM_SCOPE(Projectiles);
+	Super::BeginPlay();
+
+	// Register our light so players near it become relevant to everyone
+	if (FBlackoutLightExposureGrid* exposure = ABlackoutGameMode::GetLightExposure(this)) {
+		lightExposureHandle = exposure->AddLight(GetActorLocation(), Light->AttenuationRadius);
+		CollisionComp->TransformUpdated.AddUObject(this, &ABlackoutProjectile::OnMoved);
+	}
+
+	if (!HasAuthority()) {
+		jitterBuffer.OnArrival(FPlatformTime::Seconds());
+		SetActorTickEnabled(true);
+	}
+
+	// The shooter's own client tracks when its shot shows up
+	if (!HasAuthority() && Instigator && Instigator->IsLocallyControlled()) {
+		FBlackoutFireTrace::Get().Record(Instigator, FireTraceId, EBlackoutFireStage::ClientSpawned);
+	}
+}
+
+void ABlackoutProjectile::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ABlackoutScheduler::Cancel(this, lifeSpanTimer);
+	if (lightExposureHandle != INDEX_NONE) {
+		if (FBlackoutLightExposureGrid* exposure = ABlackoutGameMode::GetLightExposure(this)) {
+			exposure->RemoveLight(lightExposureHandle);
+		}
+		lightExposureHandle = INDEX_NONE;
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+void ABlackoutProjectile::SetLifeSpan(float InLifespan)
+{
+	// Same rules as AActor::SetLifeSpan, which AActor::BeginPlay calls with InitialLifeSpan
+	InitialLifeSpan = InLifespan;
+	ABlackoutScheduler::Cancel(this, lifeSpanTimer);
+	if ((HasAuthority() || GetTearOff()) && !IsPendingKill() && InLifespan > 0.f) {
+		if (ABlackoutScheduler* scheduler = ABlackoutScheduler::Get(this)) {
+			lifeSpanTimer = scheduler->SetTimer(EBlackoutTimerCategory::Projectiles, FSimpleDelegate::CreateUObject(this, &ABlackoutProjectile::LifeSpanExpired), InLifespan);
+		}
+	}
+}
+
+float ABlackoutProjectile::GetLifeSpan() const
+{
+	ABlackoutScheduler* scheduler = lifeSpanTimer.IsValid() ? ABlackoutScheduler::Get(this) : nullptr;
+	const float remaining = scheduler ? scheduler->GetWheel().GetRemaining(lifeSpanTimer) : -1.f;
+	return remaining >= 0.f ? remaining : 0.f;
+}
+
+void ABlackoutProjectile::PostNetReceiveLocationAndRotation()
+{
+	if (!FBlackoutJitterBuffer::IsEnabled()) {
+		Super::PostNetReceiveLocationAndRotation();
+		return;
+	}
+
+	// Follow the server's velocity right away, so bounces match, but keep drawing where we are and smooth the
+	// position error away in Tick
+	jitterBuffer.OnArrival(FPlatformTime::Seconds());
+	pendingCorrection = ReplicatedMovement.Location - GetActorLocation();
+	ProjectileMovement->Velocity = ReplicatedMovement.LinearVelocity;
+	SetActorRotation(ReplicatedMovement.Rotation);
+	ProjectileMovement->SetComponentTickEnabled(true);
+}
+
+void ABlackoutProjectile::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (FBlackoutJitterBuffer::IsEnabled()) {
+		const FVector step = pendingCorrection * FMath::Clamp(DeltaSeconds / jitterBuffer.GetBufferSeconds(), 0.f, 1.f);
+		pendingCorrection -= step;
+		AddActorWorldOffset(step);
+
+		// Hold still once updates are overdue, rather than fly on and snap back further when they resume
+		if (jitterBuffer.IsOverdue(FPlatformTime::Seconds())) {
+			ProjectileMovement->SetComponentTickEnabled(false);
+		}
+	}
+
+	smoothness.Track(TEXT("Projectile"), GetActorLocation(), DeltaSeconds);
+}
+
+void ABlackoutProjectile::OnMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	if (FBlackoutLightExposureGrid* exposure = ABlackoutGameMode::GetLightExposure(this)) {
+		exposure->UpdateLight(lightExposureHandle, UpdatedComponent->GetComponentLocation());
+	}
 }
 
 void ABlackoutProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
@@ -59,11 +169,16 @@ void ABlackoutProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor
 
 	// Only play the sound if it exists, and it's not already playing
 	if (DissipateSound != NULL && !dissipating) {
-		UGameplayStatics::PlaySoundAtLocation(this, DissipateSound, GetActorLocation());
+		ABlackoutSplitscreen::PlaySoundAtLocation(this, DissipateSound, GetActorLocation());
 	}
 	dissipating = true;
 
 	if (dynamic_cast<ABlackoutCharacter*>(OtherActor)) {
+		if (HasAuthority() && Instigator && OtherActor != Instigator) {
+			if (ABlackoutPlayerState* playerState = Instigator->GetPlayerState<ABlackoutPlayerState>()) {
+				playerState->ShotsHit++;
+			}
+		}
 		Destroy();
 	}
 	else {
@@ -71,7 +186,26 @@ void ABlackoutProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor
 	}
 }
 
+void ABlackoutProjectile::Reset()
+{
+	Super::Reset();
+	Destroy();
+}
+
 void ABlackoutProjectile::SetLightColor(FLinearColor color)
 {
 	Light->SetLightColor(color);
 }
+
+bool ABlackoutProjectile::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+	return ABlackoutArena::IsInViewerArena(ArenaIndex, RealViewer, ViewTarget)
+		&& Super::IsNetRelevantFor(RealViewer, ViewTarget, SrcLocation);
+}
+
+void ABlackoutProjectile::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(ABlackoutProjectile, FireTraceId, COND_InitialOnly);
+}
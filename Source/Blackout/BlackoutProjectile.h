@@ -6,6 +6,8 @@
 #include "GameFramework/Actor.h"
 #include "GameFramework/DamageType.h"
 #include "Components/PointLightComponent.h"
+#include "BlackoutProxySmoothing.h"
+#include "BlackoutScheduler.h"
 #include "BlackoutProjectile.generated.h"
 
 UCLASS(config=Game)
@@ -30,9 +32,36 @@ class ABlackoutProjectile : public AActor
 
 	bool dissipating = false;
 
+	/** Handle of our light in the game mode's light exposure grid, server only */
+	int32 lightExposureHandle = INDEX_NONE;
+
+	/** Keeps our entry in the light exposure grid in step with the projectile */
+	void OnMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	/** Clients: sizes how long corrections from the server are spread over */
+	FBlackoutJitterBuffer jitterBuffer;
+	FBlackoutSmoothnessTracker smoothness;
+
+	/** Clients: distance to the server's position that has not been smoothed away yet */
+	FVector pendingCorrection = FVector::ZeroVector;
+
+	/** Destroys the projectile when its life span runs out, see SetLifeSpan */
+	FBlackoutTimerHandle lifeSpanTimer;
+
 public:
 	ABlackoutProjectile();
 
+	void BeginPlay() override;
+	void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	void Tick(float DeltaSeconds) override;
+
+	/** Life spans run on the world's ABlackoutScheduler instead of a timer manager handle per projectile */
+	void SetLifeSpan(float InLifespan) override;
+	float GetLifeSpan() const override;
+
+	/** Clients: glides onto the replicated position over the jitter buffer instead of snapping to it */
+	void PostNetReceiveLocationAndRotation() override;
+
 	/** called when projectile hits something */
 	UFUNCTION()
 	void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
@@ -56,5 +85,19 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = Visual)
 	void SetLightColor(FLinearColor color);
+
+	bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
+
+	/** Shots in flight do not survive a match reset */
+	void Reset() override;
+
+	void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** FBlackoutFireTrace id of the shot that spawned us, 0 if it was not traced */
+	UPROPERTY(Replicated)
+	uint16 FireTraceId = 0;
+
+	/** Arena of the character that fired this projectile. Server only. */
+	int32 ArenaIndex = INDEX_NONE;
 };
 
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutProxySmoothing.h"
+#include "Blackout.h"
+#include "BlackoutStats.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarProxySmoothing(
+	TEXT("Blackout.ProxySmoothing"),
+	1,
+	TEXT("Smooth simulated proxies over an adaptive jitter buffer instead of the engine's fixed smoothing"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarJitterScale(
+	TEXT("Blackout.ProxySmoothing.JitterScale"),
+	2.f,
+	TEXT("Standard deviations of update arrival jitter the smoothing buffer covers"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarOverdueIntervals(
+	TEXT("Blackout.ProxySmoothing.OverdueIntervals"),
+	4.f,
+	TEXT("Mean update intervals without an update before a proxy is considered lost and holds still"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarSmoothness(
+	TEXT("Blackout.Smoothness"),
+	0,
+	TEXT("Measure how smoothly simulated proxies move. See Blackout.Smoothness.Report."),
+	ECVF_Default);
+
+/** Velocity changes between frames, by category */
+static TMap<FString, TArray<float>> SmoothnessSamples;
+
+static FAutoConsoleCommand SmoothnessReportCommand(
+	TEXT("Blackout.Smoothness.Report"),
+	TEXT("Logs frame to frame velocity change of simulated proxies, in cm/s"),
+	FConsoleCommandDelegate::CreateStatic(&FBlackoutSmoothnessTracker::LogReport));
+
+static FAutoConsoleCommand SmoothnessResetCommand(
+	TEXT("Blackout.Smoothness.Reset"),
+	TEXT("Forgets every smoothness sample"),
+	FConsoleCommandDelegate::CreateLambda([]() { SmoothnessSamples.Reset(); }));
+
+/** Weight of each new interval in the running mean and variance */
+static const float JitterSmoothing = 0.1f;
+static const float MinBufferSeconds = 0.03f;
+static const float MaxBufferSeconds = 0.3f;
+
+bool FBlackoutJitterBuffer::IsEnabled()
+{
+	return CVarProxySmoothing.GetValueOnGameThread() != 0;
+}
+
+void FBlackoutJitterBuffer::OnArrival(double now)
+{
+	const float interval = now - lastArrival;
+	lastArrival = now;
+
+	// The first update, or one after falling out of relevancy, says nothing about jitter
+	if (interval <= 0.f || interval > 1.f) {
+		return;
+	}
+	const float difference = interval - meanInterval;
+	meanInterval += JitterSmoothing * difference;
+	intervalVariance = (1.f - JitterSmoothing) * (intervalVariance + JitterSmoothing * difference * difference);
+}
+
+float FBlackoutJitterBuffer::GetBufferSeconds() const
+{
+	const float buffer = meanInterval + CVarJitterScale.GetValueOnGameThread() * FMath::Sqrt(intervalVariance);
+	return FMath::Clamp(buffer, MinBufferSeconds, MaxBufferSeconds);
+}
+
+bool FBlackoutJitterBuffer::IsOverdue(double now) const
+{
+	return lastArrival > 0.0 && now - lastArrival > CVarOverdueIntervals.GetValueOnGameThread() * meanInterval;
+}
+
+void FBlackoutSmoothnessTracker::LogReport()
+{
+	UE_LOG(LogBlackout, Display, TEXT("Proxy smoothness, velocity change per frame in cm/s:"));
+	for (TPair<FString, TArray<float>>& pair : SmoothnessSamples) {
+		const int32 count = pair.Value.Num();
+		UE_LOG(LogBlackout, Display, TEXT("  %-12s %7d frames  %s"), *pair.Key, count, *BlackoutStats::FormatPercentiles(pair.Value));
+	}
+}
+
+bool FBlackoutSmoothnessTracker::HasSamples()
+{
+	return SmoothnessSamples.Num() > 0;
+}
+
+void FBlackoutSmoothnessTracker::Track(const TCHAR* category, const FVector& location, float deltaSeconds)
+{
+	if (CVarSmoothness.GetValueOnGameThread() == 0 || deltaSeconds <= 0.f) {
+		samples = 0;
+		return;
+	}
+
+	const FVector velocity = (location - lastLocation) / deltaSeconds;
+	if (samples >= 2) {
+		SmoothnessSamples.FindOrAdd(category).Add((velocity - lastVelocity).Size());
+	}
+	lastLocation = location;
+	lastVelocity = velocity;
+	samples++;
+}
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Adaptive jitter buffer for a simulated proxy. Measures how regularly replicated updates arrive and sizes the
+ * time corrections are smoothed over to cover that: the mean interval plus `Blackout.ProxySmoothing.JitterScale`
+ * standard deviations. Steady connections get a short buffer and stay responsive, jittery ones a longer one
+ * instead of visible snaps.
+ */
+struct BLACKOUT_API FBlackoutJitterBuffer
+{
+	/** True if `Blackout.ProxySmoothing` is on */
+	static bool IsEnabled();
+
+	/** Call whenever a replicated update arrives */
+	void OnArrival(double now);
+
+	/** Seconds to smooth corrections over */
+	float GetBufferSeconds() const;
+
+	/**
+	 * True once the next update is overdue: nothing has arrived for `Blackout.ProxySmoothing.OverdueIntervals` times
+	 * the mean interval. Relative to what this proxy usually gets, so one replicated less often, e.g. because it is
+	 * out of sight, isn't mistaken for a lost one.
+	 */
+	bool IsOverdue(double now) const;
+
+	FORCEINLINE double GetLastArrival() const { return lastArrival; }
+
+private:
+	double lastArrival = 0.0;
+	float meanInterval = 0.1f;
+	float intervalVariance = 0.f;
+};
+
+/**
+ * Measures how smooth a proxy looks: the change in on-screen velocity from one frame to the next. Steady motion
+ * scores near 0, snaps score high. Enable with `Blackout.Smoothness 1`, report with `Blackout.Smoothness.Report`.
+ * The report is also logged on shutdown, see Scripts/SmoothnessTest.sh.
+ */
+struct BLACKOUT_API FBlackoutSmoothnessTracker
+{
+	/** Samples the displayed location for this frame. `category` groups proxies in the report. */
+	void Track(const TCHAR* category, const FVector& location, float deltaSeconds);
+
+	/** Logs p50 / p90 / p99 / max of every category measured so far */
+	static void LogReport();
+
+	/** True once anything has been measured */
+	static bool HasSamples();
+
+private:
+	FVector lastLocation = FVector::ZeroVector;
+	FVector lastVelocity = FVector::ZeroVector;
+	int32 samples = 0;
+};
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Token bucket for one kind of client to server RPC. Refills at a steady rate up to a burst, so normal
+ * network jitter bunching calls together is absorbed while the average rate is held to the limit.
+ * Calls made without a token are dropped. With `addDebt` they also put the bucket into debt, so a client that
+ * keeps flooding never earns tokens back; leave it off for calls a legitimate player can spam by holding a key.
+ */
+struct FBlackoutRateLimiter
+{
+	/** Calls dropped so far */
+	int32 Dropped = 0;
+
+	/** Takes a token if there is one. Returns false if the call should be dropped. */
+	bool TryConsume(double now, float ratePerSecond, float burst, bool addDebt = true)
+	{
+		tokens = FMath::Min<double>(burst, tokens + (now - lastTime) * ratePerSecond);
+		lastTime = now;
+		tokens -= 1.0;
+		if (tokens >= 0.0) {
+			return true;
+		}
+		if (!addDebt) {
+			tokens = FMath::Max(tokens, 0.0);
+		}
+		Dropped++;
+		return false;
+	}
+
+	/** True once a client has flooded far past the limit, more than any lag could explain */
+	bool IsFlooding(float maxDebt) const
+	{
+		return tokens < -maxDebt;
+	}
+
+private:
+	double tokens = 0.0;
+	double lastTime = 0.0;
+};
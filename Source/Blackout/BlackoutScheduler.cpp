@@ -0,0 +1,348 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutScheduler.h"
+#include "Blackout.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "TimerManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Gameplay scheduler"), STAT_Scheduler, STATGROUP_Blackout);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Gameplay timers fired"), STAT_SchedulerFired, STATGROUP_Blackout);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Gameplay timers active"), STAT_SchedulerActive, STATGROUP_Blackout);
+
+const double FBlackoutTimerWheel::TickSeconds = 0.01;
+
+FBlackoutTimerWheel::FBlackoutTimerWheel()
+{
+	for (int32& head : heads) {
+		head = INDEX_NONE;
+	}
+}
+
+const TCHAR* FBlackoutTimerWheel::GetCategoryName(EBlackoutTimerCategory category)
+{
+	switch (category) {
+	case EBlackoutTimerCategory::Footsteps: return TEXT("Footsteps");
+	case EBlackoutTimerCategory::Powerups: return TEXT("Powerups");
+	case EBlackoutTimerCategory::HUD: return TEXT("HUD");
+	case EBlackoutTimerCategory::Projectiles: return TEXT("Projectiles");
+	case EBlackoutTimerCategory::Other: return TEXT("Other");
+	default: return TEXT("Unknown");
+	}
+}
+
+uint64 FBlackoutTimerWheel::GetExpiryTick(double expiryTime) const
+{
+	return FMath::Max(currentTick + 1, (uint64)FMath::CeilToDouble(expiryTime / TickSeconds));
+}
+
+FBlackoutTimerHandle FBlackoutTimerWheel::SetTimer(EBlackoutTimerCategory category, FSimpleDelegate delegate, float seconds, bool repeat)
+{
+	int32 index;
+	if (freeTimers.Num() > 0) {
+		index = freeTimers.Pop(false);
+	}
+	else {
+		index = timers.AddDefaulted();
+	}
+
+	FTimer& timer = timers[index];
+	timer.Delegate = MoveTemp(delegate);
+	timer.Interval = FMath::Max(seconds, 0.f);
+	timer.ExpiryTime = time + timer.Interval;
+	timer.ExpiryTick = GetExpiryTick(timer.ExpiryTime);
+	timer.Category = category;
+	timer.bRepeat = repeat;
+	timer.bActive = true;
+	Link(index);
+	stats[(int32)category].Active++;
+
+	FBlackoutTimerHandle handle;
+	handle.Index = index;
+	handle.Serial = timer.Serial;
+	return handle;
+}
+
+bool FBlackoutTimerWheel::IsActive(const FBlackoutTimerHandle& handle) const
+{
+	return timers.IsValidIndex(handle.Index) && timers[handle.Index].bActive && timers[handle.Index].Serial == handle.Serial;
+}
+
+float FBlackoutTimerWheel::GetRemaining(const FBlackoutTimerHandle& handle) const
+{
+	return IsActive(handle) ? FMath::Max(0.f, float(timers[handle.Index].ExpiryTime - time)) : -1.f;
+}
+
+void FBlackoutTimerWheel::Cancel(FBlackoutTimerHandle& handle)
+{
+	if (IsActive(handle)) {
+		if (timers[handle.Index].Slot != INDEX_NONE) {
+			Unlink(handle.Index);
+		}
+		Free(handle.Index);
+	}
+	handle.Invalidate();
+}
+
+void FBlackoutTimerWheel::Link(int32 index)
+{
+	FTimer& timer = timers[index];
+
+	// Timers further out than the top level reaches wait in it, and are sorted again when it comes round
+	const uint64 maxDelta = (uint64(1) << (SlotBits * Levels)) - 1;
+	const uint64 delta = FMath::Min(timer.ExpiryTick - currentTick, maxDelta);
+	int32 level = 0;
+	while (level < Levels - 1 && delta >= (uint64(1) << (SlotBits * (level + 1)))) {
+		level++;
+	}
+	const uint64 tick = currentTick + delta;
+	const int32 slot = level * Slots + (int32)((tick >> (SlotBits * level)) & (Slots - 1));
+
+	timer.Slot = slot;
+	timer.Prev = INDEX_NONE;
+	timer.Next = heads[slot];
+	if (heads[slot] != INDEX_NONE) {
+		timers[heads[slot]].Prev = index;
+	}
+	heads[slot] = index;
+}
+
+void FBlackoutTimerWheel::Unlink(int32 index)
+{
+	FTimer& timer = timers[index];
+	if (timer.Prev != INDEX_NONE) {
+		timers[timer.Prev].Next = timer.Next;
+	}
+	else {
+		heads[timer.Slot] = timer.Next;
+	}
+	if (timer.Next != INDEX_NONE) {
+		timers[timer.Next].Prev = timer.Prev;
+	}
+	timer.Prev = INDEX_NONE;
+	timer.Next = INDEX_NONE;
+	timer.Slot = INDEX_NONE;
+}
+
+void FBlackoutTimerWheel::Free(int32 index)
+{
+	FTimer& timer = timers[index];
+	timer.Delegate.Unbind();
+	timer.bActive = false;
+	timer.Serial++;
+	stats[(int32)timer.Category].Active--;
+	freeTimers.Add(index);
+}
+
+void FBlackoutTimerWheel::Cascade(int32 level)
+{
+	const int32 slot = level * Slots + (int32)((currentTick >> (SlotBits * level)) & (Slots - 1));
+	int32 index = heads[slot];
+	heads[slot] = INDEX_NONE;
+	while (index != INDEX_NONE) {
+		const int32 next = timers[index].Next;
+		Link(index);
+		index = next;
+	}
+}
+
+void FBlackoutTimerWheel::Advance(float deltaSeconds)
+{
+	time += deltaSeconds;
+	const uint64 targetTick = (uint64)(time / TickSeconds);
+	while (currentTick < targetTick) {
+		currentTick++;
+
+		// A level's slot is sorted down each time every level below it has gone all the way round
+		for (int32 level = 1; level < Levels && (currentTick & ((uint64(1) << (SlotBits * level)) - 1)) == 0; level++) {
+			Cascade(level);
+		}
+
+		int32& head = heads[currentTick & (Slots - 1)];
+		while (head != INDEX_NONE) {
+			const int32 index = head;
+			Unlink(index);
+			due[(int32)timers[index].Category].Add(index);
+		}
+	}
+	Dispatch();
+}
+
+void FBlackoutTimerWheel::Dispatch()
+{
+	for (int32 category = 0; category < (int32)EBlackoutTimerCategory::Count; category++) {
+		TArray<int32>& batch = due[category];
+		stats[category].FiredLastAdvance = batch.Num();
+		if (batch.Num() == 0) {
+			continue;
+		}
+
+		const double start = FPlatformTime::Seconds();
+		for (const int32 index : batch) {
+			// Cancelled by an earlier callback, or cancelled and reused for a timer that is not due
+			FTimer& timer = timers[index];
+			if (!timer.bActive || timer.Slot != INDEX_NONE) {
+				continue;
+			}
+
+			// Callbacks may set timers, which can move `timers`, so call a copy
+			FSimpleDelegate delegate;
+			if (timer.bRepeat) {
+				delegate = timer.Delegate;
+				timer.ExpiryTime += timer.Interval;
+				timer.ExpiryTick = GetExpiryTick(timer.ExpiryTime);
+				Link(index);
+			}
+			else {
+				delegate = MoveTemp(timer.Delegate);
+				Free(index);
+			}
+			stats[category].Fired++;
+			delegate.ExecuteIfBound();
+		}
+		batch.Reset();
+		stats[category].DispatchSeconds += FPlatformTime::Seconds() - start;
+	}
+}
+
+ABlackoutScheduler::ABlackoutScheduler()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+	bReplicates = false;
+}
+
+ABlackoutScheduler* ABlackoutScheduler::Get(const UObject* worldContext)
+{
+	UWorld* world = worldContext ? worldContext->GetWorld() : nullptr;
+	if (!world) {
+		return nullptr;
+	}
+	for (TActorIterator<ABlackoutScheduler> it(world); it; ++it) {
+		return *it;
+	}
+	return world->SpawnActor<ABlackoutScheduler>();
+}
+
+void ABlackoutScheduler::Cancel(const UObject* worldContext, FBlackoutTimerHandle& handle)
+{
+	UWorld* world = worldContext ? worldContext->GetWorld() : nullptr;
+	if (world && handle.IsValid()) {
+		for (TActorIterator<ABlackoutScheduler> it(world); it; ++it) {
+			it->Wheel.Cancel(handle);
+		}
+	}
+	handle.Invalidate();
+}
+
+void ABlackoutScheduler::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_Scheduler);
+	Super::Tick(DeltaSeconds);
+	Wheel.Advance(DeltaSeconds);
+
+	int32 fired = 0;
+	int32 active = 0;
+	for (int32 category = 0; category < (int32)EBlackoutTimerCategory::Count; category++) {
+		fired += Wheel.GetStats((EBlackoutTimerCategory)category).FiredLastAdvance;
+		active += Wheel.GetStats((EBlackoutTimerCategory)category).Active;
+	}
+	INC_DWORD_STAT_BY(STAT_SchedulerFired, fired);
+	SET_DWORD_STAT(STAT_SchedulerActive, active);
+}
+
+static FAutoConsoleCommandWithWorld SchedulerReportCommand(
+	TEXT("Blackout.Scheduler.Report"),
+	TEXT("Logs active timers, timers fired and dispatch cost per category"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		ABlackoutScheduler* scheduler = nullptr;
+		for (TActorIterator<ABlackoutScheduler> it(World); it; ++it) {
+			scheduler = *it;
+		}
+		if (!scheduler) {
+			UE_LOG(LogBlackout, Display, TEXT("No gameplay scheduler in this world"));
+			return;
+		}
+		for (int32 category = 0; category < (int32)EBlackoutTimerCategory::Count; category++) {
+			const FBlackoutTimerWheel::FCategoryStats& stats = scheduler->GetWheel().GetStats((EBlackoutTimerCategory)category);
+			UE_LOG(LogBlackout, Display, TEXT("  %-12s %6d active %10llu fired %8.2f us per dispatch"),
+				FBlackoutTimerWheel::GetCategoryName((EBlackoutTimerCategory)category), stats.Active, stats.Fired,
+				stats.Fired > 0 ? stats.DispatchSeconds * 1e6 / stats.Fired : 0.0);
+		}
+	}));
+
+/**
+ * Blackout.Scheduler.Benchmark [timers=10000] [frames=600]
+ * Runs the same repeating timers, 0.1 to 5 seconds apart, on a timer wheel and on an FTimerManager outside of
+ * any world, stepping both at 60 frames per second. Logs the time to set them, tick them and cancel them.
+ */
+static FAutoConsoleCommand SchedulerBenchmarkCommand(
+	TEXT("Blackout.Scheduler.Benchmark"),
+	TEXT("Compares the gameplay timer wheel with FTimerManager: Blackout.Scheduler.Benchmark [timers=10000] [frames=600]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 numTimers = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 10000;
+		const int32 numFrames = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 600;
+		const float frameSeconds = 1.f / 60.f;
+
+		FRandomStream random(numTimers);
+		TArray<float> intervals;
+		for (int32 i = 0; i < numTimers; i++) {
+			intervals.Add(random.FRandRange(0.1f, 5.f));
+		}
+
+		int32 wheelFired = 0;
+		FBlackoutTimerWheel wheel;
+		TArray<FBlackoutTimerHandle> wheelHandles;
+		wheelHandles.SetNum(numTimers);
+		double start = FPlatformTime::Seconds();
+		for (int32 i = 0; i < numTimers; i++) {
+			wheelHandles[i] = wheel.SetTimer(EBlackoutTimerCategory::Other, FSimpleDelegate::CreateLambda([&wheelFired]() { wheelFired++; }), intervals[i], true);
+		}
+		const double wheelSetMs = (FPlatformTime::Seconds() - start) * 1000.0;
+		start = FPlatformTime::Seconds();
+		for (int32 frame = 0; frame < numFrames; frame++) {
+			wheel.Advance(frameSeconds);
+		}
+		const double wheelTickMs = (FPlatformTime::Seconds() - start) * 1000.0;
+		start = FPlatformTime::Seconds();
+		for (FBlackoutTimerHandle& handle : wheelHandles) {
+			wheel.Cancel(handle);
+		}
+		const double wheelCancelMs = (FPlatformTime::Seconds() - start) * 1000.0;
+
+		int32 managerFired = 0;
+		FTimerManager manager;
+		TArray<FTimerHandle> managerHandles;
+		managerHandles.SetNum(numTimers);
+		start = FPlatformTime::Seconds();
+		for (int32 i = 0; i < numTimers; i++) {
+			manager.SetTimer(managerHandles[i], FTimerDelegate::CreateLambda([&managerFired]() { managerFired++; }), intervals[i], true);
+		}
+		const double managerSetMs = (FPlatformTime::Seconds() - start) * 1000.0;
+
+		// FTimerManager only ticks once per engine frame, so step the frame counter for it and put it back after
+		const uint64 frameCounter = GFrameCounter;
+		start = FPlatformTime::Seconds();
+		for (int32 frame = 0; frame < numFrames; frame++) {
+			GFrameCounter++;
+			manager.Tick(frameSeconds);
+		}
+		const double managerTickMs = (FPlatformTime::Seconds() - start) * 1000.0;
+		GFrameCounter = frameCounter;
+		start = FPlatformTime::Seconds();
+		for (FTimerHandle& handle : managerHandles) {
+			manager.ClearTimer(handle);
+		}
+		const double managerCancelMs = (FPlatformTime::Seconds() - start) * 1000.0;
+
+		UE_LOG(LogBlackout, Display, TEXT("Scheduler benchmark, %d repeating timers over %d frames:"), numTimers, numFrames);
+		UE_LOG(LogBlackout, Display, TEXT("  %-14s set %8.3f ms  tick %8.3f ms (%.4f ms per frame)  cancel %8.3f ms  fired %d"),
+			TEXT("Timer wheel"), wheelSetMs, wheelTickMs, wheelTickMs / FMath::Max(numFrames, 1), wheelCancelMs, wheelFired);
+		UE_LOG(LogBlackout, Display, TEXT("  %-14s set %8.3f ms  tick %8.3f ms (%.4f ms per frame)  cancel %8.3f ms  fired %d"),
+			TEXT("FTimerManager"), managerSetMs, managerTickMs, managerTickMs / FMath::Max(numFrames, 1), managerCancelMs, managerFired);
+	}));
@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "BlackoutScheduler.generated.h"
+
+/** What a gameplay timer is for. Statistics are kept, and due timers dispatched together, per category. */
+enum class EBlackoutTimerCategory : uint8
+{
+	Footsteps,
+	Powerups,
+	HUD,
+	Projectiles,
+	Other,
+	Count
+};
+
+/** Refers to a timer in an FBlackoutTimerWheel. Stays safe to use after the timer has fired or been cancelled. */
+struct FBlackoutTimerHandle
+{
+	int32 Index = INDEX_NONE;
+	uint32 Serial = 0;
+
+	FORCEINLINE bool IsValid() const { return Index != INDEX_NONE; }
+	FORCEINLINE void Invalidate() { Index = INDEX_NONE; }
+};
+
+/**
+ * Hierarchical timer wheel: four levels of 64 slots, the first TickSeconds per slot and each level 64 times
+ * coarser than the one below. Setting and cancelling a timer is O(1); a slot of a higher level is only sorted down
+ * when the wheel reaches it. Timers that come due during Advance are dispatched together at the end of it, one
+ * category after the other.
+ */
+class BLACKOUT_API FBlackoutTimerWheel
+{
+public:
+	struct FCategoryStats
+	{
+		int32 Active = 0;
+		uint64 Fired = 0;
+		int32 FiredLastAdvance = 0;
+		double DispatchSeconds = 0;
+	};
+
+	/** Timers are rounded up to a multiple of this */
+	static const double TickSeconds;
+
+	FBlackoutTimerWheel();
+
+	/** Calls `delegate` in `seconds`, and every `seconds` after that if `repeat` */
+	FBlackoutTimerHandle SetTimer(EBlackoutTimerCategory category, FSimpleDelegate delegate, float seconds, bool repeat);
+
+	/** Stops a timer if it is still active, and invalidates the handle */
+	void Cancel(FBlackoutTimerHandle& handle);
+
+	bool IsActive(const FBlackoutTimerHandle& handle) const;
+
+	/** Seconds until the timer fires, -1 if it is not active */
+	float GetRemaining(const FBlackoutTimerHandle& handle) const;
+
+	/** Moves time forward, firing every timer that came due */
+	void Advance(float deltaSeconds);
+
+	FORCEINLINE double GetTime() const { return time; }
+	FORCEINLINE const FCategoryStats& GetStats(EBlackoutTimerCategory category) const { return stats[(int32)category]; }
+
+	static const TCHAR* GetCategoryName(EBlackoutTimerCategory category);
+
+private:
+	static const int32 Levels = 4;
+	static const int32 SlotBits = 6;
+	static const int32 Slots = 1 << SlotBits;
+
+	struct FTimer
+	{
+		FSimpleDelegate Delegate;
+		double Interval = 0;
+		double ExpiryTime = 0;
+		uint64 ExpiryTick = 0;
+		uint32 Serial = 0;
+		/** Neighbours in the slot's list, INDEX_NONE at the ends */
+		int32 Prev = INDEX_NONE;
+		int32 Next = INDEX_NONE;
+		/** Slot the timer is listed in, INDEX_NONE while it is due or free */
+		int32 Slot = INDEX_NONE;
+		EBlackoutTimerCategory Category = EBlackoutTimerCategory::Other;
+		bool bRepeat = false;
+		bool bActive = false;
+	};
+
+	/** First tick at or after `expiryTime`, and never the current one */
+	uint64 GetExpiryTick(double expiryTime) const;
+
+	/** Adds a timer to the slot its ExpiryTick falls in */
+	void Link(int32 index);
+	void Unlink(int32 index);
+	void Free(int32 index);
+
+	/** Sorts the current slot of a higher level down into the levels below */
+	void Cascade(int32 level);
+
+	void Dispatch();
+
+	TArray<FTimer> timers;
+	TArray<int32> freeTimers;
+
+	/** First timer in each slot, level by level */
+	int32 heads[Levels * Slots];
+
+	/** Timers that came due during this Advance, by category */
+	TArray<int32> due[(int32)EBlackoutTimerCategory::Count];
+
+	FCategoryStats stats[(int32)EBlackoutTimerCategory::Count];
+
+	uint64 currentTick = 0;
+	double time = 0;
+};
+
+/**
+ * Gameplay timers for one world, on a single FBlackoutTimerWheel instead of a timer manager handle per actor.
+ * Footsteps, powerup respawns, the HUD's game over message and projectile lifespans run on it.
+ * `Blackout.Scheduler.Report` logs statistics per category, `Blackout.Scheduler.Benchmark` compares the wheel
+ * with FTimerManager.
+ */
+UCLASS()
+class BLACKOUT_API ABlackoutScheduler : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	ABlackoutScheduler();
+
+	/** Returns the world's scheduler, spawning it if needed */
+	static ABlackoutScheduler* Get(const UObject* worldContext);
+
+	/** Cancels a timer if the world still has a scheduler. Never spawns one, so it is safe in EndPlay. */
+	static void Cancel(const UObject* worldContext, FBlackoutTimerHandle& handle);
+
+	FORCEINLINE FBlackoutTimerHandle SetTimer(EBlackoutTimerCategory category, FSimpleDelegate delegate, float seconds, bool repeat = false)
+	{
+		return Wheel.SetTimer(category, MoveTemp(delegate), seconds, repeat);
+	}
+
+	FORCEINLINE FBlackoutTimerWheel& GetWheel() { return Wheel; }
+
+	void Tick(float DeltaSeconds) override;
+
+private:
+	FBlackoutTimerWheel Wheel;
+};
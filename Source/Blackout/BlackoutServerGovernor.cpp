@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutServerGovernor.h"
+#include "Blackout.h"
+#include "BlackoutGameMode.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Server governor tier"), STAT_ServerGovernorTier, STATGROUP_Blackout);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Server busy ms (smoothed)"), STAT_ServerGovernorBusyMs, STATGROUP_Blackout);
+
+static TAutoConsoleVariable<int32> CVarGovernorForceTier(
+	TEXT("Blackout.Governor.ForceTier"),
+	-1,
+	TEXT("Server: pins the governor to a tier (0 Full, 1 Reduced, 2 Minimal), -1 lets it follow frame time"),
+	ECVF_Default);
+
+static const TCHAR* GetTierName(EBlackoutServerTier tier)
+{
+	switch (tier) {
+	case EBlackoutServerTier::Full: return TEXT("Full");
+	case EBlackoutServerTier::Reduced: return TEXT("Reduced");
+	case EBlackoutServerTier::Minimal: return TEXT("Minimal");
+	default: return TEXT("Unknown");
+	}
+}
+
+ABlackoutServerGovernor::ABlackoutServerGovernor()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+	bReplicates = false;
+
+	TargetFrameMs = 0.f;
+	ReducedAtRatio = 0.9f;
+	MinimalAtRatio = 1.1f;
+	RestoreAtRatio = 0.7f;
+	EscalateSeconds = 1.f;
+	RestoreSeconds = 5.f;
+	SmoothingSeconds = 0.5f;
+	MinimalProjectileNetUpdateFrequency = 20.f;
+}
+
+ABlackoutServerGovernor* ABlackoutServerGovernor::Get(const UObject* worldContext)
+{
+	UWorld* world = worldContext ? worldContext->GetWorld() : nullptr;
+	ABlackoutGameMode* gameMode = world ? world->GetAuthGameMode<ABlackoutGameMode>() : nullptr;
+	return gameMode ? gameMode->GetGovernor() : nullptr;
+}
+
+EBlackoutServerTier ABlackoutServerGovernor::GetTier(const UObject* worldContext)
+{
+	ABlackoutServerGovernor* governor = Get(worldContext);
+	return governor ? governor->Tier : EBlackoutServerTier::Full;
+}
+
+float ABlackoutServerGovernor::GetBudgetMs() const
+{
+	if (TargetFrameMs > 0.f) {
+		return TargetFrameMs;
+	}
+	// On a dedicated server this is the net driver's NetServerMaxTickRate
+	const float maxTickRate = GEngine ? GEngine->GetMaxTickRate(0.f, false) : 0.f;
+	return maxTickRate > 0.f ? 1000.f / maxTickRate : 1000.f / 30.f;
+}
+
+void ABlackoutServerGovernor::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+	tierSeconds += DeltaSeconds;
+
+	// Time the last frame spent working, not sleeping off the rest of its tick
+	const float busyMs = FMath::Max(0.0, FApp::GetDeltaTime() - FApp::GetIdleTime()) * 1000.f;
+	smoothedBusyMs = FMath::Lerp(smoothedBusyMs, busyMs, FMath::Clamp(DeltaSeconds / FMath::Max(SmoothingSeconds, KINDA_SMALL_NUMBER), 0.f, 1.f));
+	SET_FLOAT_STAT(STAT_ServerGovernorBusyMs, smoothedBusyMs);
+	SET_DWORD_STAT(STAT_ServerGovernorTier, (uint32)Tier);
+
+	const int32 forcedTier = CVarGovernorForceTier.GetValueOnGameThread();
+	if (forcedTier >= 0) {
+		const EBlackoutServerTier tier = (EBlackoutServerTier)FMath::Min(forcedTier, (int32)EBlackoutServerTier::Minimal);
+		if (tier != Tier) {
+			SetTier(tier);
+		}
+		return;
+	}
+
+	const float budgetMs = GetBudgetMs();
+	EBlackoutServerTier target = Tier;
+	if (smoothedBusyMs > budgetMs * MinimalAtRatio) {
+		target = EBlackoutServerTier::Minimal;
+	}
+	else if (smoothedBusyMs > budgetMs * ReducedAtRatio) {
+		target = FMath::Max(Tier, EBlackoutServerTier::Reduced);
+	}
+	else if (smoothedBusyMs < budgetMs * RestoreAtRatio && Tier != EBlackoutServerTier::Full) {
+		// Restore one tier at a time, the work it brings back may be enough to fall behind again
+		target = (EBlackoutServerTier)((uint8)Tier - 1);
+	}
+
+	if (target == Tier || target != pendingTier) {
+		pendingTier = target;
+		pendingSeconds = 0.f;
+		return;
+	}
+
+	pendingSeconds += DeltaSeconds;
+	if (pendingSeconds >= (target > Tier ? EscalateSeconds : RestoreSeconds)) {
+		SetTier(target);
+	}
+}
+
+void ABlackoutServerGovernor::SetTier(EBlackoutServerTier newTier)
+{
+	UE_LOG(LogBlackout, Warning, TEXT("Server governor: %s -> %s (busy %.1f ms of %.1f ms, %.1f s in %s)"),
+		GetTierName(Tier), GetTierName(newTier), smoothedBusyMs, GetBudgetMs(), tierSeconds, GetTierName(Tier));
+
+	Tier = newTier;
+	pendingTier = newTier;
+	pendingSeconds = 0.f;
+	tierSeconds = 0.f;
+}
@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "BlackoutServerGovernor.generated.h"
+
+/** How much non-essential work the server is doing, from everything to the bare minimum */
+UENUM()
+enum class EBlackoutServerTier : uint8
+{
+	/** Everything runs */
+	Full,
+	/** Jump and out of ammo multicasts and last shot light colors are dropped */
+	Reduced,
+	/** Fire multicasts are dropped too and new projectiles replicate less often */
+	Minimal,
+};
+
+/**
+ * Dedicated server frame time governor. Watches how long the server is busy each frame against its tick
+ * budget and, when it falls behind, sheds purely cosmetic work in tiers so hit registration and movement
+ * keep their time. Tiers come back one at a time once there is headroom again.
+ *
+ * Tier changes are logged, and `stat Blackout` shows the current tier and busy time.
+ * Spawned by ABlackoutGameMode on dedicated servers only, see GetTier.
+ */
+UCLASS(config=Game)
+class BLACKOUT_API ABlackoutServerGovernor : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	ABlackoutServerGovernor();
+
+	/** Returns the world's governor, null on clients and when not on a dedicated server */
+	static ABlackoutServerGovernor* Get(const UObject* worldContext);
+
+	/** Current tier of the world's server. Always Full on clients and when there is no governor. */
+	static EBlackoutServerTier GetTier(const UObject* worldContext);
+
+	void Tick(float DeltaSeconds) override;
+
+	/** Busy time per frame to stay within. 0 uses the server's max tick rate. */
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	float TargetFrameMs;
+
+	/** Fraction of the budget above which the server goes to Reduced */
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	float ReducedAtRatio;
+
+	/** Fraction of the budget above which the server goes to Minimal */
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	float MinimalAtRatio;
+
+	/** Fraction of the budget below which a tier is restored */
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	float RestoreAtRatio;
+
+	/** How long the server must be over a threshold before shedding */
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	float EscalateSeconds;
+
+	/** How long the server must have headroom before restoring a tier */
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	float RestoreSeconds;
+
+	/** Time constant of the busy time average, so single hitches do not change tiers */
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	float SmoothingSeconds;
+
+	/** NetUpdateFrequency of projectiles spawned while in Minimal */
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	float MinimalProjectileNetUpdateFrequency;
+
+	FORCEINLINE EBlackoutServerTier GetCurrentTier() const { return Tier; }
+
+private:
+	float GetBudgetMs() const;
+	void SetTier(EBlackoutServerTier newTier);
+
+	EBlackoutServerTier Tier = EBlackoutServerTier::Full;
+
+	/** Tier the server has been heading towards, and for how long */
+	EBlackoutServerTier pendingTier = EBlackoutServerTier::Full;
+	float pendingSeconds = 0.f;
+
+	/** Seconds spent in the current tier, for the log */
+	float tierSeconds = 0.f;
+
+	float smoothedBusyMs = 0.f;
+};
@@ -0,0 +1,197 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlackoutSplitscreen.h"
+#include "Blackout.h"
+#include "BlackoutCharacter.h"
+#include "BlackoutLoadGenerator.h"
+#include "BlackoutStats.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/FileManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+DECLARE_CYCLE_STAT(TEXT("Splitscreen sharing"), STAT_Splitscreen, STATGROUP_Blackout);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Splitscreen sounds deduped"), STAT_SplitscreenSoundsDeduped, STATGROUP_Blackout);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Splitscreen lights shared"), STAT_SplitscreenLightsShared, STATGROUP_Blackout);
+
+/** Seconds skipped before the split-screen test starts sampling, while the extra players spawn in */
+static const float SplitscreenTestWarmupSeconds = 5.f;
+
+ABlackoutSplitscreen::ABlackoutSplitscreen()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+	bReplicates = false;
+
+	LightShareDistance = 300.f;
+}
+
+ABlackoutSplitscreen* ABlackoutSplitscreen::Get(const UObject* worldContext)
+{
+	UWorld* world = worldContext ? worldContext->GetWorld() : nullptr;
+	if (!world) {
+		return nullptr;
+	}
+	for (TActorIterator<ABlackoutSplitscreen> it(world); it; ++it) {
+		return *it;
+	}
+	if (!GEngine || GEngine->GetNumGamePlayers(world) < 2) {
+		return nullptr;
+	}
+	return world->SpawnActor<ABlackoutSplitscreen>();
+}
+
+void ABlackoutSplitscreen::StartIfRequested(UWorld* world)
+{
+	UGameInstance* gameInstance = world ? world->GetGameInstance() : nullptr;
+	if (!gameInstance || world->GetNetMode() == NM_Client || world->GetNetMode() == NM_DedicatedServer) {
+		return;
+	}
+
+	int32 localPlayers = 0;
+	if (FParse::Value(FCommandLine::Get(), TEXT("BlackoutLocalPlayers="), localPlayers)) {
+		localPlayers = FMath::Clamp(localPlayers, 1, 4);
+		while (gameInstance->GetNumLocalPlayers() < localPlayers) {
+			FString error;
+			if (!gameInstance->CreateLocalPlayer(-1, error, true)) {
+				UE_LOG(LogBlackout, Error, TEXT("Can't add local player %d: %s"), gameInstance->GetNumLocalPlayers() + 1, *error);
+				break;
+			}
+		}
+	}
+
+	float seconds = 0.f;
+	if (FParse::Value(FCommandLine::Get(), TEXT("SplitscreenTest="), seconds) && seconds > 0.f) {
+		// Spawned even for a single local player, so that run gives the baseline the others are compared with
+		ABlackoutSplitscreen* splitscreen = Get(world);
+		if (!splitscreen) {
+			splitscreen = world->SpawnActor<ABlackoutSplitscreen>();
+		}
+		if (splitscreen && splitscreen->testSeconds <= 0.f) {
+			splitscreen->testSeconds = seconds;
+			UE_LOG(LogBlackout, Display, TEXT("Split-screen test: %d local players for %.0f seconds"), gameInstance->GetNumLocalPlayers(), seconds);
+		}
+	}
+}
+
+void ABlackoutSplitscreen::PlaySoundAtLocation(const UObject* source, USoundBase* sound, const FVector& location)
+{
+	if (!sound || FBlackoutLoadGenerator::IsHeadless()) {
+		return;
+	}
+	ABlackoutSplitscreen* splitscreen = Get(source);
+	if (splitscreen && !splitscreen->ClaimSound(source, sound)) {
+		return;
+	}
+	UGameplayStatics::PlaySoundAtLocation(source, sound, location);
+}
+
+bool ABlackoutSplitscreen::ClaimSound(const UObject* source, USoundBase* sound)
+{
+	if (soundsFrame != GFrameCounter) {
+		soundsFrame = GFrameCounter;
+		sounds.Reset();
+	}
+
+	const TPair<const UObject*, USoundBase*> key(source, sound);
+	if (sounds.Contains(key)) {
+		soundsDeduped++;
+		INC_DWORD_STAT(STAT_SplitscreenSoundsDeduped);
+		return false;
+	}
+	sounds.Add(key);
+	soundsPlayed++;
+	return true;
+}
+
+void ABlackoutSplitscreen::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+	SCOPE_CYCLE_COUNTER(STAT_Splitscreen);
+
+	ShareLights();
+	if (testSeconds > 0.f) {
+		SampleTest(DeltaSeconds);
+	}
+}
+
+void ABlackoutSplitscreen::ShareLights()
+{
+	TArray<ABlackoutCharacter*, TInlineAllocator<4>> characters;
+	for (FConstPlayerControllerIterator it = GetWorld()->GetPlayerControllerIterator(); it; ++it) {
+		APlayerController* playerController = it->Get();
+		ABlackoutCharacter* character = playerController && playerController->IsLocalController()
+			? Cast<ABlackoutCharacter>(playerController->GetPawn()) : nullptr;
+		if (character && character->GetPersonalLight()) {
+			characters.Add(character);
+		}
+	}
+
+	// Earlier players keep their light, so the one left on doesn't flicker between players standing together.
+	// The light's colour shows its player's health, so only a light that looks the same can stand in for it.
+	const float distanceSquared = FMath::Square(LightShareDistance);
+	for (int32 i = 0; i < characters.Num(); i++) {
+		UPointLightComponent* light = characters[i]->GetPersonalLight();
+		bool shared = false;
+		for (int32 j = 0; j < i && !shared; j++) {
+			const UPointLightComponent* other = characters[j]->GetPersonalLight();
+			shared = other->IsVisible()
+				&& other->GetLightColor().Equals(light->GetLightColor())
+				&& FMath::IsNearlyEqual(other->Intensity, light->Intensity)
+				&& FVector::DistSquared(characters[i]->GetActorLocation(), characters[j]->GetActorLocation()) <= distanceSquared;
+		}
+		if (light->IsVisible() == shared) {
+			light->SetVisibility(!shared);
+		}
+		if (shared) {
+			INC_DWORD_STAT(STAT_SplitscreenLightsShared);
+		}
+	}
+}
+
+void ABlackoutSplitscreen::SampleTest(float DeltaSeconds)
+{
+	testElapsed += DeltaSeconds;
+	if (testElapsed < SplitscreenTestWarmupSeconds) {
+		soundsPlayed = 0;
+		soundsDeduped = 0;
+		return;
+	}
+	gameThreadMs.Add(FMath::Max(0.0, FApp::GetDeltaTime() - FApp::GetIdleTime()) * 1000.0);
+	if (testElapsed >= SplitscreenTestWarmupSeconds + testSeconds) {
+		FinishTest();
+	}
+}
+
+void ABlackoutSplitscreen::FinishTest()
+{
+	testSeconds = 0.f;
+	gameThreadMs.Sort();
+
+	const int32 localPlayers = GetWorld()->GetGameInstance()->GetNumLocalPlayers();
+	const FString row = FString::Printf(TEXT("%s,%d,%.3f,%.3f,%.3f,%d,%d\n"),
+		*UGameplayStatics::GetCurrentLevelName(this, true), localPlayers,
+		BlackoutStats::Percentile(gameThreadMs, 50.f), BlackoutStats::Percentile(gameThreadMs, 95.f),
+		BlackoutStats::Percentile(gameThreadMs, 99.f), soundsPlayed, soundsDeduped);
+
+	const FString path = FPaths::Combine(FPaths::ProfilingDir(), TEXT("Splitscreen.csv"));
+	if (!FPaths::FileExists(path)) {
+		FFileHelper::SaveStringToFile(FString(TEXT("Map,LocalPlayers,GameThreadMs.p50,GameThreadMs.p95,GameThreadMs.p99,SoundsPlayed,SoundsDeduped\n")), *path);
+	}
+	FFileHelper::SaveStringToFile(row, *path, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+
+	UE_LOG(LogBlackout, Display, TEXT("Split-screen test: %d local players, game thread p50 %.2f ms / p95 %.2f ms, %d sounds played, %d deduped. Wrote %s"),
+		localPlayers, BlackoutStats::Percentile(gameThreadMs, 50.f), BlackoutStats::Percentile(gameThreadMs, 95.f),
+		soundsPlayed, soundsDeduped, *path);
+	FPlatformMisc::RequestExitWithStatus(false, 0);
+}
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "BlackoutSplitscreen.generated.h"
+
+class USoundBase;
+
+/**
+ * Shares cosmetic work between the local players of a split-screen game, so each extra player costs less than the
+ * first. Spawned per world once there is more than one local player, see Get.
+ *
+ * - World sounds go through PlaySoundAtLocation, which drops a sound its source actor already started this frame,
+ *   such as a projectile's dissipate sound on a second hit. Different actors' sounds always play, even when they
+ *   are the same sound in the same place, since each one is gameplay information.
+ * - Local players standing close together share one PersonalLight instead of stacking several, as long as their
+ *   lights have the same colour and intensity, i.e. show the same health.
+ *
+ * Measuring: -BlackoutLocalPlayers=<n> adds local players at the start of the match, and -SplitscreenTest=<seconds>
+ * samples game thread time, appends a row to Saved/Profiling/Splitscreen.csv and exits. See Scripts/SplitscreenTest.sh.
+ */
+UCLASS(config=Game)
+class BLACKOUT_API ABlackoutSplitscreen : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	ABlackoutSplitscreen();
+
+	/** Returns the world's split-screen sharing, spawning it if needed. Null with fewer than two local players. */
+	static ABlackoutSplitscreen* Get(const UObject* worldContext);
+
+	/** Adds local players and starts the split-screen test if asked to on the command line */
+	static void StartIfRequested(UWorld* world);
+
+	/** Plays a one shot world sound from `source`, unless `source` already started the same sound this frame */
+	static void PlaySoundAtLocation(const UObject* source, USoundBase* sound, const FVector& location);
+
+	void Tick(float DeltaSeconds) override;
+
+	/** Local players closer than this share one PersonalLight */
+	UPROPERTY(Config, EditAnywhere, Category = "Splitscreen")
+	float LightShareDistance;
+
+private:
+	/** Returns false if `source` already started the sound this frame */
+	bool ClaimSound(const UObject* source, USoundBase* sound);
+
+	/** Turns off the PersonalLight of local players standing next to another local player's identical lit one */
+	void ShareLights();
+
+	void SampleTest(float DeltaSeconds);
+	void FinishTest();
+
+	/** Sounds started this frame, by their source */
+	TArray<TPair<const UObject*, USoundBase*>> sounds;
+	uint64 soundsFrame = 0;
+
+	/** Length of the split-screen test, 0 if not running it */
+	float testSeconds = 0.f;
+	float testElapsed = 0.f;
+	TArray<float> gameThreadMs;
+	int32 soundsPlayed = 0;
+	int32 soundsDeduped = 0;
+};
@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Small helpers shared by Blackout's instrumentation */
+namespace BlackoutStats
+{
+	/** Returns the p-th percentile (0-100) of an already sorted array, or 0 if it is empty. Nearest rank. */
+	template<typename T>
+	T Percentile(const TArray<T>& sorted, float p)
+	{
+		if (sorted.Num() == 0) {
+			return T(0);
+		}
+		const int32 index = FMath::Clamp(FMath::CeilToInt(p / 100.f * sorted.Num()) - 1, 0, sorted.Num() - 1);
+		return sorted[index];
+	}
+
+	/** Formats "p50 / p90 / p99 / max" of an unsorted sample array. Sorts `samples` in place. */
+	template<typename T>
+	FString FormatPercentiles(TArray<T>& samples)
+	{
+		samples.Sort();
+		return FString::Printf(TEXT("p50 %.2f / p90 %.2f / p99 %.2f / max %.2f"),
+			(double)Percentile(samples, 50.f), (double)Percentile(samples, 90.f),
+			(double)Percentile(samples, 99.f), (double)Percentile(samples, 100.f));
+	}
+}
@@ -3,10 +3,13 @@
 
 #include "Powerup.h"
 #include "Net/UnrealNetwork.h"
+#include "BlackoutArena.h"
+#include "BlackoutMemory.h"
 
 // Sets default values
 APowerup::APowerup()
 {
+	BLACKOUT_LLM_SCOPE(Powerups);
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
@@ -23,6 +26,7 @@ APowerup::APowerup()
 // Called when the game starts or when spawned
 void APowerup::BeginPlay()
 {
+	BLACKOUT_LLM_SCOPE(Powerups);
 	Super::BeginPlay();
 }
 
@@ -51,9 +55,8 @@ void APowerup::OnTrigger(UPrimitiveComponent* OverlappedComp, AActor* OtherActor
 	}
 
 	SetVisible(false);
-	UWorld* world = GetWorld();
-	if (world) {
-		world->GetTimerManager().SetTimer(respawnTimer, this, &APowerup::Respawn, RespawnTime, false);
+	if (ABlackoutScheduler* scheduler = ABlackoutScheduler::Get(this)) {
+		respawnTimer = scheduler->SetTimer(EBlackoutTimerCategory::Powerups, FSimpleDelegate::CreateUObject(this, &APowerup::Respawn), RespawnTime);
 	}
 	else {
 		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, TEXT("!!!Attempted to trigger powerup when not spawned. Tell Fred if you ever see this message."));
@@ -77,6 +80,14 @@ void APowerup::Respawn()
 	SetVisible(true);
 }
 
+void APowerup::Reset()
+{
+	Super::Reset();
+
+	ABlackoutScheduler::Cancel(this, respawnTimer);
+	SetVisible(true);
+}
+
 void APowerup::Powerup(ABlackoutCharacter* character) {
 	GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, TEXT("!!!void powerup. Tell Fred if you ever see this message."));
 }
@@ -93,3 +104,9 @@ void APowerup::GetLifetimeReplicatedProps(TArray <FLifetimeProperty>& OutLifetim
 	//Replicate current health.
 	DOREPLIFETIME(APowerup, isVisible);
 }
+
+bool APowerup::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+	return ABlackoutArena::IsInViewerArena(ArenaIndex, RealViewer, ViewTarget)
+		&& Super::IsNetRelevantFor(RealViewer, ViewTarget, SrcLocation);
+}
@@ -7,6 +7,7 @@
 #include "Components/SphereComponent.h"
 #include "Engine/StaticMesh.h"
 #include "BlackoutCharacter.h"
+#include "BlackoutScheduler.h"
 #include "Powerup.generated.h"
 
 
@@ -37,6 +38,9 @@ protected:
 
 	void Respawn();
 
+	/** Makes the powerup available again immediately. Called when the match is reset in place. */
+	void Reset() override;
+
 	void SetVisible(bool state);
 	bool GetVisible() { return isVisible; }
 	void OnVisibilityUpdate();
@@ -49,12 +53,16 @@ public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 	void GetLifetimeReplicatedProps(TArray <FLifetimeProperty>& OutLifetimeProps) const override;
+	bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
+
+	/** Arena whose level instance this powerup belongs to. Server only. */
+	int32 ArenaIndex = INDEX_NONE;
 
 private:
 
 	virtual void Powerup(ABlackoutCharacter* character);
 
-	FTimerHandle respawnTimer;
+	FBlackoutTimerHandle respawnTimer;
 	
 	UFUNCTION()
 	void OnRep_Visibility();